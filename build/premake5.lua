@@ -196,6 +196,7 @@ if (downloadRaylib) then
         }
         
         files {"../src/**.c", "../src/**.cpp", "../src/**.h", "../src/**.hpp", "../include/**.h", "../include/**.hpp"}
+        removefiles {"../src/cli/**", "../src/bench/**", "../src/test/**"}
         
         filter {"system:windows", "action:vs*"}
             files {"../src/*.rc", "../src/*.ico"}
@@ -227,6 +228,9 @@ if (downloadRaylib) then
             links {"winmm", "gdi32", "opengl32"}
             libdirs {"../bin/%{cfg.buildcfg}"}
 
+        filter {"system:windows", "action:gmake*"}
+            links {"pthread"}
+
         filter "system:linux"
             links {"pthread", "m", "dl", "rt"}
 
@@ -242,6 +246,102 @@ if (downloadRaylib) then
         filter{}
         
 
+    -- headless solver front end, no raylib and no window
+    project (workspaceName .. "-cli")
+        kind "ConsoleApp"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        vpaths 
+        {
+            ["Header Files/*"] = { "../src/solver/**.h" },
+            ["Source Files/*"] = { "../src/solver/**.c", "../src/cli/**.c" },
+        }
+
+        files {"../src/solver/**.c", "../src/solver/**.h", "../src/cli/**.c"}
+
+        includedirs { "../src" }
+
+        cdialect "C17"
+
+        flags { "ShadowedVariables"}
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+            characterset ("Unicode")
+
+        filter {"system:windows", "action:gmake*"}
+            links {"pthread"}
+
+        filter "system:linux"
+            links {"pthread", "m"}
+
+        filter{}
+
+    -- solver benchmark with a seeded maze generator, no raylib
+    project (workspaceName .. "-bench")
+        kind "ConsoleApp"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        vpaths 
+        {
+            ["Header Files/*"] = { "../src/solver/**.h", "../src/bench/**.h" },
+            ["Source Files/*"] = { "../src/solver/**.c", "../src/bench/**.c" },
+        }
+
+        files {"../src/solver/**.c", "../src/solver/**.h", "../src/bench/**.c", "../src/bench/**.h"}
+
+        includedirs { "../src" }
+
+        cdialect "C17"
+
+        flags { "ShadowedVariables"}
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+            characterset ("Unicode")
+
+        filter {"system:windows", "action:gmake*"}
+            links {"pthread"}
+
+        filter "system:linux"
+            links {"pthread", "m"}
+
+        filter{}
+
+    -- seeded checks of the solver against plain counterparts, no raylib
+    project (workspaceName .. "-test")
+        kind "ConsoleApp"
+        location "build_files/"
+        targetdir "../bin/%{cfg.buildcfg}"
+
+        vpaths 
+        {
+            ["Header Files/*"] = { "../src/solver/**.h", "../src/bench/mazegen.h", "../src/test/**.h" },
+            ["Source Files/*"] = { "../src/solver/**.c", "../src/bench/mazegen.c", "../src/test/**.c" },
+        }
+
+        files {"../src/solver/**.c", "../src/solver/**.h", "../src/bench/mazegen.c", "../src/bench/mazegen.h", "../src/test/**.c", "../src/test/**.h"}
+
+        includedirs { "../src" }
+
+        cdialect "C17"
+
+        flags { "ShadowedVariables"}
+
+        filter "action:vs*"
+            defines{"_CRT_SECURE_NO_WARNINGS"}
+            characterset ("Unicode")
+
+        filter {"system:windows", "action:gmake*"}
+            links {"pthread"}
+
+        filter "system:linux"
+            links {"pthread", "m"}
+
+        filter{}
+
     project "raylib"
         kind "StaticLib"
     
@@ -0,0 +1,222 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/mazegen.h"
+#include "solver/solver.h"
+
+// benchmark: generate (or read) a maze, then time every solver phase on it and
+// print one CSV line or JSON object per phase and run
+static void PrintUsage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --rows N       generated maze rows (default 200)\n"
+        "  --cols N       generated maze columns (default 200)\n"
+        "  --density F    obstacle chance per free cell (default 0.1)\n"
+        "  --targets K    objectives to place (default 8)\n"
+        "  --corridor W   carve a maze with W-cell corridors, 0 is an open field (default 0)\n"
+        "  --seed S       generator seed (default 1)\n"
+        "  --maze F       benchmark the maze file F instead of generating one\n"
+        "  --binary       store the generated maze in the binary format\n"
+        "  --keep F       write the generated maze to F and keep it\n"
+        "  --runs N       repetitions, each on a fresh solver (default 3)\n"
+        "  --threads N    worker threads for parallel phases (default: one per CPU)\n"
+        "  --no-exact     skip the exact bitmask solver\n"
+        "  --no-held-karp skip the Held-Karp solver\n"
+        "  --no-approx    skip the approximate solver\n"
+        "  --no-replan    skip the replanner build and the one-cell re-plan\n"
+        "  --json         print JSON instead of CSV\n"
+        "  --out F        write the results to F instead of stdout\n",
+        prog);
+}
+
+// working buffers the solver reported since the stats were last reset, in KB
+static long PhaseKB(const SolverStats *stats) {
+    size_t bytes = 0;
+    for (int p = 0; p < STATS_PHASE_COUNT; p++) bytes += stats->bytes[p];
+    return (long)(bytes >> 10);
+}
+
+typedef struct {
+    const char *maze;
+    MazeGenParams gen;
+    bool generated;
+    int rows, cols, reachable;
+    int run;
+    const char *phase;
+    double ms;
+    size_t states;      // states the phase expanded, 0 when it does not count them
+    int cost;           // tour cost, -1 when the phase has none
+    long phaseKB;       // buffers of this phase alone (SolverStats.bytes), not the process peak
+} BenchRecord;
+
+static bool jsonFirst = true;
+
+static void PrintRecord(FILE *out, bool json, const BenchRecord *rec) {
+    double nsPerState = rec->states ? rec->ms * 1e6 / (double)rec->states : 0;
+    if (json) {
+        fprintf(out, "%s\n  {\"maze\": \"%s\", \"rows\": %d, \"cols\": %d, ", jsonFirst ? "" : ",", rec->maze, rec->rows, rec->cols);
+        if (rec->generated) {
+            fprintf(out, "\"seed\": %llu, \"density\": %g, \"corridor\": %d, \"targets\": %d, ",
+                    (unsigned long long)rec->gen.seed, rec->gen.density, rec->gen.corridor, rec->gen.targets);
+        }
+        fprintf(out, "\"reachable\": %d, \"run\": %d, \"phase\": \"%s\", \"ms\": %.3f, \"states\": %zu, \"ns_per_state\": %.2f, \"cost\": %d, \"phase_kb\": %ld}",
+                rec->reachable, rec->run, rec->phase, rec->ms, rec->states, nsPerState, rec->cost, rec->phaseKB);
+        jsonFirst = false;
+    } else {
+        fprintf(out, "%s,%d,%d,", rec->maze, rec->rows, rec->cols);
+        if (rec->generated) {
+            fprintf(out, "%llu,%g,%d,%d,", (unsigned long long)rec->gen.seed, rec->gen.density, rec->gen.corridor, rec->gen.targets);
+        } else {
+            fprintf(out, ",,,,");
+        }
+        fprintf(out, "%d,%d,%s,%.3f,%zu,%.2f,%d,%ld\n",
+                rec->reachable, rec->run, rec->phase, rec->ms, rec->states, nsPerState, rec->cost, rec->phaseKB);
+    }
+    fflush(out);
+}
+
+typedef bool (*SolveFn)(SolverContext *ctx);
+
+// walls off the cell under the middle of the current path and re-plans around it
+static bool BlockPathAndReplan(SolverContext *ctx) {
+    if (ctx->tspPath.count == 0) return false;
+    PathStep mid = PathTraceAt(ctx, &ctx->tspPath, ctx->tspPath.count / 2);
+    SetMazeCell(ctx, mid.x, mid.y, 0);
+    return Replan(ctx);
+}
+
+static bool BenchSolve(FILE *out, bool json, BenchRecord *rec, SolverContext *ctx, const char *phase, SolveFn solve) {
+    ctx->expandedStates = 0;
+    resetSolverStats(ctx->stats);
+    double t0 = SolverGetTime();
+    bool solved = solve(ctx);
+    rec->ms = (SolverGetTime() - t0) * 1e3;
+    rec->phase = phase;
+    rec->states = ctx->expandedStates;
+    rec->cost = solved ? ctx->totalFuelCost : -1;
+    rec->phaseKB = PhaseKB(ctx->stats);
+    PrintRecord(out, json, rec);
+    return solved;
+}
+
+int main(int argc, char **argv) {
+    MazeGenParams gen = {200, 200, 0.1, 8, 0, 1};
+    const char *mazeFile = NULL;
+    const char *keepFile = NULL;
+    const char *outFile = NULL;
+    bool binary = false, json = false;
+    bool runExact = true, runHeldKarp = true, runApprox = true, runReplan = true;
+    int runs = 3, workerCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--rows") == 0 && hasValue) gen.rows = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cols") == 0 && hasValue) gen.cols = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--density") == 0 && hasValue) gen.density = atof(argv[++i]);
+        else if (strcmp(argv[i], "--targets") == 0 && hasValue) gen.targets = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--corridor") == 0 && hasValue) gen.corridor = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) gen.seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--maze") == 0 && hasValue) mazeFile = argv[++i];
+        else if (strcmp(argv[i], "--binary") == 0) binary = true;
+        else if (strcmp(argv[i], "--keep") == 0 && hasValue) keepFile = argv[++i];
+        else if (strcmp(argv[i], "--runs") == 0 && hasValue) runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) workerCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--no-exact") == 0) runExact = false;
+        else if (strcmp(argv[i], "--no-held-karp") == 0) runHeldKarp = false;
+        else if (strcmp(argv[i], "--no-approx") == 0) runApprox = false;
+        else if (strcmp(argv[i], "--no-replan") == 0) runReplan = false;
+        else if (strcmp(argv[i], "--json") == 0) json = true;
+        else if (strcmp(argv[i], "--out") == 0 && hasValue) outFile = argv[++i];
+        else { PrintUsage(argv[0]); return 2; }
+    }
+
+    // the generated maze goes through a file so LoadMaze is timed like a real load
+    bool generated = mazeFile == NULL;
+    if (generated) {
+        mazeFile = keepFile ? keepFile : "pathfinder-bench.maze";
+        uint8_t *grid = GenerateMaze(&gen);
+        if (!grid) { fprintf(stderr, "error: cannot generate a %d x %d maze\n", gen.rows, gen.cols); return 1; }
+        bool written = WriteMazeText(grid, gen.rows, gen.cols, mazeFile);
+        free(grid);
+        if (written && binary) {
+            SolverContext conv;
+            SolverInit(&conv);
+            written = LoadMaze(&conv, mazeFile) && SaveMazeBinary(&conv, mazeFile);
+            SolverFree(&conv);
+        }
+        if (!written) { fprintf(stderr, "error: cannot write '%s'\n", mazeFile); return 1; }
+    }
+
+    FILE *out = outFile ? fopen(outFile, "w") : stdout;
+    if (out == NULL) { fprintf(stderr, "error: cannot write '%s'\n", outFile); return 1; }
+    if (json) fprintf(out, "[");
+    else fprintf(out, "maze,rows,cols,seed,density,corridor,targets,reachable,run,phase,ms,states,ns_per_state,cost,phase_kb\n");
+
+    int status = 0;
+    for (int run = 0; run < runs; run++) {
+        SolverContext ctx;
+        SolverInit(&ctx);
+        SolverStats stats;
+        resetSolverStats(&stats);
+        ctx.stats = &stats;
+        ctx.workerCount = workerCount;
+        BenchRecord rec = {mazeFile, gen, generated, 0, 0, 0, run, NULL, 0, 0, -1, 0};
+
+        double t0 = SolverGetTime();
+        if (!LoadMaze(&ctx, mazeFile)) {
+            fprintf(stderr, "error: cannot read maze '%s'\n", mazeFile);
+            status = 1;
+            break;
+        }
+        rec.ms = (SolverGetTime() - t0) * 1e3;
+        rec.rows = ctx.rows;
+        rec.cols = ctx.cols;
+        rec.phase = "load";
+        rec.states = (size_t)ctx.rows * ctx.cols;
+        rec.phaseKB = PhaseKB(&stats);
+        PrintRecord(out, json, &rec);
+
+        size_t totalPoses = (size_t)ctx.rows * ctx.cols * 4;
+        resetSolverStats(&stats);
+        t0 = SolverGetTime();
+        CheckAccessibility(&ctx);
+        rec.ms = (SolverGetTime() - t0) * 1e3;
+        rec.reachable = ctx.reachableCount;
+        rec.phase = "accessibility";
+        rec.states = 0;
+        for (size_t i = 0; i < totalPoses; i++) rec.states += ctx.visited[i];
+        rec.phaseKB = PhaseKB(&stats);
+        PrintRecord(out, json, &rec);
+
+        // one full single-source search from the start pose
+        int *dist = (int*)malloc(totalPoses * sizeof(int));
+        if (dist) {
+            t0 = SolverGetTime();
+            DijkstraAll(&ctx, ctx.start_state.x, ctx.start_state.y, ctx.start_state.mode, dist);
+            rec.ms = (SolverGetTime() - t0) * 1e3;
+            rec.phase = "dijkstra";
+            rec.states = 0;
+            for (size_t i = 0; i < totalPoses; i++) rec.states += dist[i] != INT_MAX;
+            rec.phaseKB = (long)(totalPoses * sizeof(int) >> 10);    // the distances; DijkstraAll reports no buffers
+            PrintRecord(out, json, &rec);
+            free(dist);
+        }
+
+        if (ctx.reachableCount > 0) {
+            if (runExact && ctx.reachableCount <= EXACT_TARGET_LIMIT) BenchSolve(out, json, &rec, &ctx, "exact", SolveTSP_Exact);
+            if (runHeldKarp && ctx.reachableCount <= HELD_KARP_TARGET_LIMIT) BenchSolve(out, json, &rec, &ctx, "held-karp", SolveTSP_HeldKarp);
+            if (runApprox) BenchSolve(out, json, &rec, &ctx, "approx", SolveTSP_Approx);
+            if (runReplan && BenchSolve(out, json, &rec, &ctx, "replan-start", StartReplanner)) {
+                BenchSolve(out, json, &rec, &ctx, "replan", BlockPathAndReplan);
+            }
+        }
+        SolverFree(&ctx);
+    }
+
+    if (json) fprintf(out, "\n]\n");
+    if (outFile) fclose(out);
+    if (generated && !keepFile) remove(mazeFile);
+    return status;
+}
@@ -0,0 +1,119 @@
+#include "mazegen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Maze generator
+//
+// Open field: every cell is free, then obstacles are scattered at the given density.
+// Corridor mode: rooms of corridor x corridor cells on a pitch of corridor + 1 are
+// joined by a randomized depth-first spanning tree, so every room is connected, and
+// obstacles are scattered on top. The start area is cleared last in both modes.
+
+static uint64_t NextRandom(uint64_t *state) {
+    // splitmix64
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+static double RandomUnit(uint64_t *state) { return (double)(NextRandom(state) >> 11) * (1.0 / 9007199254740992.0); }
+static size_t RandomBelow(uint64_t *state, size_t n) { return (size_t)(NextRandom(state) % n); }
+
+static void FillRect(uint8_t *grid, int cols, int r0, int c0, int h, int w, uint8_t val) {
+    for (int r = r0; r < r0 + h; r++) memset(grid + (size_t)r * cols + c0, val, (size_t)w);
+}
+
+static void CarveCorridors(uint8_t *grid, int rows, int cols, int width, uint64_t *rng) {
+    int pitch = width + 1;
+    int roomRows = (rows - 1) / pitch, roomCols = (cols - 1) / pitch;
+    if (roomRows == 0 || roomCols == 0) return;
+    size_t roomCount = (size_t)roomRows * roomCols;
+    bool *seen = (bool*)calloc(roomCount, sizeof(bool));
+    size_t *stack = (size_t*)malloc(roomCount * sizeof(size_t));
+    if (!seen || !stack) { free(seen); free(stack); return; }
+
+    static const int dirs[4][2] = {{0,1},{1,0},{0,-1},{-1,0}};
+    size_t top = 0;
+    stack[top++] = 0;
+    seen[0] = true;
+    FillRect(grid, cols, 1, 1, width, width, 1);
+    while (top > 0) {
+        size_t room = stack[top - 1];
+        int rr = (int)(room / roomCols), rc = (int)(room % roomCols);
+        int options[4], optionCount = 0;
+        for (int d = 0; d < 4; d++) {
+            int nr = rr + dirs[d][0], nc = rc + dirs[d][1];
+            if (nr < 0 || nc < 0 || nr >= roomRows || nc >= roomCols) continue;
+            if (!seen[(size_t)nr * roomCols + nc]) options[optionCount++] = d;
+        }
+        if (optionCount == 0) { top--; continue; }
+
+        int d = options[RandomBelow(rng, (size_t)optionCount)];
+        int nr = rr + dirs[d][0], nc = rc + dirs[d][1];
+        seen[(size_t)nr * roomCols + nc] = true;
+        stack[top++] = (size_t)nr * roomCols + nc;
+        // the new room and the wall strip towards it
+        FillRect(grid, cols, 1 + nr * pitch, 1 + nc * pitch, width, width, 1);
+        int r0 = 1 + (rr < nr ? rr : nr) * pitch, c0 = 1 + (rc < nc ? rc : nc) * pitch;
+        if (dirs[d][0] != 0) FillRect(grid, cols, r0 + width, c0, 1, width, 1);
+        else FillRect(grid, cols, r0, c0 + width, width, 1, 1);
+    }
+    free(seen);
+    free(stack);
+}
+
+uint8_t* GenerateMaze(const MazeGenParams *params) {
+    int rows = params->rows, cols = params->cols;
+    if (rows < 5 || cols < 4 || params->corridor < 0) return NULL;
+    size_t cells = (size_t)rows * cols;
+    uint8_t *grid = (uint8_t*)malloc(cells);
+    if (!grid) return NULL;
+    uint64_t rng = params->seed;
+
+    if (params->corridor > 0) {
+        memset(grid, 0, cells);
+        CarveCorridors(grid, rows, cols, params->corridor, &rng);
+    } else {
+        memset(grid, 1, cells);
+    }
+    if (params->density > 0) {
+        for (size_t i = 0; i < cells; i++) {
+            if (grid[i] == 1 && RandomUnit(&rng) < params->density) grid[i] = 0;
+        }
+    }
+
+    // car in mode 0 at (1, 1) with a free margin around it
+    FillRect(grid, cols, 0, 0, 5, 4, 1);
+    FillRect(grid, cols, 1, 1, 3, 2, 2);
+
+    // targets on free cells: random probes first, a scan from a random cell when those miss
+    for (int t = 0; t < params->targets; t++) {
+        size_t cell = cells;
+        for (int attempt = 0; attempt < 1000 && cell == cells; attempt++) {
+            size_t i = RandomBelow(&rng, cells);
+            if (grid[i] == 1) cell = i;
+        }
+        for (size_t k = 0, from = RandomBelow(&rng, cells); k < cells && cell == cells; k++) {
+            if (grid[(from + k) % cells] == 1) cell = (from + k) % cells;
+        }
+        if (cell == cells) break;
+        grid[cell] = 3;
+    }
+    return grid;
+}
+
+bool WriteMazeText(const uint8_t *grid, int rows, int cols, const char *filename) {
+    FILE *outf = fopen(filename, "wb");
+    if (outf == NULL) return false;
+    char *line = (char*)malloc((size_t)cols + 1);
+    bool ok = line != NULL;
+    for (int r = 0; r < rows && ok; r++) {
+        for (int c = 0; c < cols; c++) line[c] = (char)('0' + grid[(size_t)r * cols + c]);
+        line[cols] = '\n';
+        ok = fwrite(line, 1, (size_t)cols + 1, outf) == (size_t)cols + 1;
+    }
+    free(line);
+    if (fclose(outf) != 0) ok = false;
+    return ok;
+}
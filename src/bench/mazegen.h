@@ -0,0 +1,23 @@
+#ifndef PATHFINDER_MAZEGEN_H
+#define PATHFINDER_MAZEGEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// seeded maze generator for the benchmark, the same parameters always give the same maze
+typedef struct {
+    int rows, cols;
+    double density;     // chance of a single-cell obstacle on each free cell
+    int targets;        // objectives placed on free cells
+    int corridor;       // 0: open field, otherwise a carved maze with corridors this many cells wide (the car is 2x3)
+    uint64_t seed;
+} MazeGenParams;
+
+// rows*cols cell values in the LoadMaze digits (0 wall, 1 free, 2 car, 3 objective),
+// with the car in mode 0 at (1, 1) on a cleared start area. Returns NULL on bad sizes.
+uint8_t* GenerateMaze(const MazeGenParams *params);
+
+// text format that LoadMaze reads
+bool WriteMazeText(const uint8_t *grid, int rows, int cols, const char *filename);
+
+#endif
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "solver/solver.h"
+
+// headless front end: solve a maze file and print cost, path and timings
+static void PrintUsage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options] <maze-file>\n"
+        "  --exact        always use the exact bitmask solver\n"
+        "  --held-karp    always use the exact Held-Karp solver\n"
+        "  --approx       always use the approximate (Christofides) solver\n"
+        "  --threads N    worker threads for parallel phases (default: one per CPU)\n"
+        "  --heap         use the binary heap even when bucket queues apply\n"
+        "  --hash-store   keep exact solver states in a hash map instead of dense arrays\n"
+        "  --no-astar     run the exact solver as plain Dijkstra (no lower bound)\n"
+        "  --time-budget S  spend up to S seconds improving the approximate tour\n"
+        "  --memory-budget MB  memory a solve may use (default: 3/4 of the available RAM)\n"
+        "  --no-path      do not print the path steps\n"
+        "  --quiet        only print the summary line\n"
+        "  --stats F      write counters and phase timings as JSON to F (- for stdout)\n"
+        "  --save-binary F  write the maze in the binary format to F and exit\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    const char *mazeFile = NULL;
+    TSPEngine engine = TSP_AUTO;
+    bool printPath = true;
+    bool quiet = false;
+    PQEngine queueEngine = PQ_AUTO;
+    StoreEngine stateStore = STORE_AUTO;
+    bool exactHeuristic = true;
+    int workerCount = 0;
+    double timeBudget = 0;
+    size_t memoryBudget = 0;
+    const char *binaryOut = NULL;
+    const char *statsOut = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--exact") == 0) engine = TSP_EXACT;
+        else if (strcmp(argv[i], "--held-karp") == 0) engine = TSP_HELD_KARP;
+        else if (strcmp(argv[i], "--approx") == 0) engine = TSP_APPROX;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) workerCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--heap") == 0) queueEngine = PQ_HEAP;
+        else if (strcmp(argv[i], "--hash-store") == 0) stateStore = STORE_HASH;
+        else if (strcmp(argv[i], "--no-astar") == 0) exactHeuristic = false;
+        else if (strcmp(argv[i], "--time-budget") == 0 && i + 1 < argc) timeBudget = atof(argv[++i]);
+        else if (strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc) memoryBudget = (size_t)strtoull(argv[++i], NULL, 10) << 20;
+        else if (strcmp(argv[i], "--no-path") == 0) printPath = false;
+        else if (strcmp(argv[i], "--quiet") == 0) { quiet = true; printPath = false; }
+        else if (strcmp(argv[i], "--save-binary") == 0 && i + 1 < argc) binaryOut = argv[++i];
+        else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) statsOut = argv[++i];
+        else if (argv[i][0] == '-') { PrintUsage(argv[0]); return 2; }
+        else mazeFile = argv[i];
+    }
+    if (mazeFile == NULL) { PrintUsage(argv[0]); return 2; }
+
+    SolverContext ctx;
+    SolverInit(&ctx);
+    ctx.queueEngine = queueEngine;
+    ctx.stateStore = stateStore;
+    ctx.exactHeuristic = exactHeuristic;
+    ctx.tspEngine = engine;
+    ctx.workerCount = workerCount;
+    ctx.approxTimeBudget = timeBudget;
+    ctx.memoryBudget = memoryBudget;
+    SolverStats stats;
+    resetSolverStats(&stats);
+    if (statsOut) ctx.stats = &stats;
+
+    double t0 = SolverGetTime();
+    if (!LoadMaze(&ctx, mazeFile)) {
+        fprintf(stderr, "error: cannot read maze '%s'\n", mazeFile);
+        return 1;
+    }
+    double t1 = SolverGetTime();
+    if (binaryOut) {
+        bool saved = SaveMazeBinary(&ctx, binaryOut);
+        if (!saved) fprintf(stderr, "error: cannot write '%s'\n", binaryOut);
+        SolverFree(&ctx);
+        return saved ? 0 : 1;
+    }
+    CheckAccessibility(&ctx);
+    double t2 = SolverGetTime();
+
+    bool solved = SolveTSP(&ctx);
+    double t3 = SolverGetTime();
+
+    if (!quiet) {
+        printf("maze: %d x %d, start (%d, %d) mode %d\n", ctx.rows, ctx.cols, ctx.start_state.x, ctx.start_state.y, ctx.start_state.mode);
+        printf("objectives: %d / %d reachable\n", ctx.reachableCount, ctx.objCount);
+        if (engine == TSP_AUTO && ctx.reachableCount > 0) {
+            printf("plan: %s (exact ~%zu MB, held-karp ~%zu MB, approx ~%zu MB; budget %zu MB)\n", TSPEngineName(ctx.plan.engine),
+                   ctx.plan.bytes[TSP_EXACT] >> 20, ctx.plan.bytes[TSP_HELD_KARP] >> 20, ctx.plan.bytes[TSP_APPROX] >> 20,
+                   ctx.plan.budget == SIZE_MAX ? 0 : ctx.plan.budget >> 20);
+        }
+        printf("engine: %s\n", TSPEngineName(ctx.engineUsed));
+        if (ctx.engineUsed == TSP_EXACT) printf("expanded states: %zu\n", ctx.expandedStates);
+        printf("timings (ms): load %.3f, accessibility %.3f, solve %.3f\n",
+               (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t3 - t2) * 1e3);
+    }
+    if (solved) printf("cost: %d steps: %d\n", ctx.totalFuelCost, ctx.tspPath.count);
+    else printf("cost: -1 steps: 0\n");
+
+    if (printPath && solved) {
+        printf("path (x y mode):\n");
+        PathCursor step;
+        for (bool more = PathCursorSeek(&step, &ctx, &ctx.tspPath, 0); more; more = PathCursorNext(&step)) {
+            printf("%d %d %d\n", step.step.x, step.step.y, step.step.m);
+        }
+    }
+
+    if (statsOut) {
+        FILE *outf = strcmp(statsOut, "-") == 0 ? stdout : fopen(statsOut, "w");
+        if (outf) {
+            writeSolverStatsJSON(&stats, outf);
+            if (outf != stdout) fclose(outf);
+        } else {
+            fprintf(stderr, "error: cannot write '%s'\n", statsOut);
+        }
+    }
+
+    SolverFree(&ctx);
+    return solved ? 0 : 1;
+}
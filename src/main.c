@@ -2,287 +2,97 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <limits.h>
-#include <stdint.h> 
 
 #include "resource_dir.h"
+#include "solver/solver.h"
 
 // constants
-#define MAX_COLS 30
-#define MAX_ROWS 30
-#define MAX_OBJ_COUNT 100
-#define INIT_HEAP_CAPACITY 4000
 #define PLAYBACK_FRAME_INTERVAL 10
-
-// coordinate index
-#define GET_IDX(r, c, m, mk, cols, maxMask) \
-    ((size_t)(r) * cols * 4 * maxMask + (size_t)(c) * 4 * maxMask + (size_t)(m) * maxMask + mk)
-#define IDX_POS(r, c, m, cols) \
-    ((size_t)(r) * cols * 4 + (size_t)(c) * 4 + m)
-
-// [mode][dir][0:new_mode, 1:dx, 2:dy, 3:fuel]
-const int Mode_Movement_Fuel[4][8][4] = {
-    {{0,0,1,1},{0,0,-1,1},{0,1,0,3},{0,-1,0,3},{1,2,0,3},{1,1,1,3},{3,0,2,3},{3,-1,1,3}},
-    {{1,1,0,1},{1,-1,0,1},{1,0,-1,3},{1,0,1,3},{2,0,2,3},{2,-1,1,3},{0,-2,0,3},{0,-1,-1,3}},
-    {{2,0,-1,1},{2,0,1,1},{2,-1,0,3},{2,1,0,3},{3,-2,0,3},{3,-1,-1,3},{1,0,-2,3},{1,1,-1,3}},
-    {{3,-1,0,1},{3,1,0,1},{3,0,1,3},{3,0,-1,3},{0,0,-2,3},{0,1,-1,3},{2,2,0,3},{2,1,1,3}}
-};
+#define TITLE_FONT_SIZE 16
+#define TITLE_CHAR_SPACING 12
+#define TITLE_LINE_HEIGHT (TITLE_FONT_SIZE + 2)
+#define MAZE_DISPLAY_MARGIN 40
+#define MAZE_TEXTURE_MAX 2048       // texels per side of the maze texture
+#define MAZE_TEXTURE_CELL_MAX 64    // pixels per cell the maze texture is drawn with at most
+#define MAZE_DETAIL_ZOOM 8.0f       // from this zoom on, visible cells are drawn one by one
+#define MAZE_ZOOM_MAX 64.0f
+#define VIEW_PAN_SPEED 600.0f       // screen pixels per second for the arrow keys
 
 // state machine
 typedef enum { 
     StartMenu = 0, 
     MazeConfirm,
     AccessibilityCheck,
-    PathPlayback
+    PathPlayback,
+    LiveEdit
 } AppScreen;
 
-// structures
-typedef struct {
-    int x, y, mode;
-} State;
-typedef struct {
-    State *items;
-    int head, tail;
-    int capacity;
-} Queue;
-
-
-typedef struct {
-    int x, y;
-    int mode;
-    int mask;   // bitmask
-    int cost;
-} PQNode;
-typedef struct {
-    PQNode *nodes;
-    int size;
-    int capacity;
-} MinHeap;
-
-// step for playback
-typedef struct { int x, y, m; } PathStep;
-
-typedef struct { int x, y; bool reachable; } Objective;
-
-typedef struct { 
-    int x, y; 
-    int originalIdx; 
-} ActiveTarget;
-
 // window
 const int screenWidth = 1280;
 const int screenHeight = 800;
 int currentX, currentY;
 
 // maze
-int **maze = NULL;
-int rows = 0, cols = 0;
+SolverContext solver;
 bool mazeLoaded = false;
-int mazeDisplayMargin, availableWidth, availableHeight, cellSize;
-int mazePixelWidth, mazePixelHeight, offsetX, offsetY;
+
+// maze view, world units are cells
+Camera2D camera = {0};
+float fitZoom = 1.0f;           // the zoom that shows the whole maze
+bool followCar = false;
 
 // accessibility check
-Queue* q = NULL;
-State start_state;
-Objective objectives[MAX_OBJ_COUNT]; 
-int objCount = 0;
-bool visited[MAX_ROWS][MAX_COLS][4];
-int reachableCount = 0;
 bool accessChecked = false;
 
 // TSP
-int *tspDist = NULL;
-size_t *tspParent = NULL;
-PathStep* tspPathTrace = NULL;
-int tspStepCount = 0;
 bool solvedTSP = false;
-int totalFuelCost = 0;
+SolveTask *solveTask = NULL;     // running background solve, the solver context is off limits until it finishes
+SolverProgress solveProgress;
+bool solveCancelled = false;
+double solveStartTime = 0;
+
+// instrumentation overlay
+SolverStats solverStats;
+bool showStats = false;
 
 // playback
-int currentPlaybackStep = 0;
+PathCursor playback;    // decodes solver.tspPath one step per frame interval
 int playbackFrameCounter = 0;
 bool playbackFinished = false;
 
-Queue* createQueue(int capacity) {
-    Queue* q = (Queue*)malloc(sizeof(Queue));
-    q->items = (State*)malloc(sizeof(State) * capacity);
-    q->head = q->tail = 0;
-    q->capacity = capacity;
-    return q;
-}
-bool isQueueEmpty(Queue* q) { return q->head == q->tail; }
-void enqueue(Queue* q, State s) { q->items[q->tail++] = s; }
-State dequeue(Queue* q) { return q->items[q->head++]; }
-void freeQueue(Queue* q) { free(q->items); free(q); }
-
-
-MinHeap* createMinHeap(int capacity) {
-    MinHeap* h = (MinHeap*)malloc(sizeof(MinHeap));
-    h->nodes = (PQNode*)malloc(sizeof(PQNode) * capacity);
-    h->size = 0;
-    h->capacity = capacity;
-    return h;
-}
-void resizeHeap(MinHeap* h) {
-    h->capacity *= 2;
-    h->nodes = (PQNode*)realloc(h->nodes, sizeof(PQNode) * h->capacity);
-}
-void pushHeap(MinHeap* h, PQNode n) {
-    if (h->size == h->capacity) resizeHeap(h);
-    int i = h->size++;
-    while (i > 0) {
-        int p = (i - 1) / 2;
-        if (h->nodes[p].cost <= n.cost) break;
-        h->nodes[i] = h->nodes[p];
-        i = p;
-    }
-    h->nodes[i] = n;
-}
-PQNode popHeap(MinHeap* h) {
-    PQNode ret = h->nodes[0];
-    PQNode n = h->nodes[--h->size];
-    int i = 0;
-    while (i * 2 + 1 < h->size) {
-        int a = i * 2 + 1;
-        int b = i * 2 + 2;
-        if (b < h->size && h->nodes[b].cost < h->nodes[a].cost) a = b;
-        if (h->nodes[a].cost >= n.cost) break;
-        h->nodes[i] = h->nodes[a];
-        i = a;
-    }
-    h->nodes[i] = n;
-    return ret;
-}
-void freeHeap(MinHeap* h) { free(h->nodes); free(h); }
-
-void GetCarBody(int mode, int body[6][2]) {
-    switch(mode) {
-        case 0: { int b[6][2]={{0,0},{1,0},{0,1},{1,1},{0,2},{1,2}}; memcpy(body, b, sizeof(b)); break; }
-        case 1: { int b[6][2]={{0,0},{-1,0},{-2,0},{0,1},{-1,1},{-2,1}}; memcpy(body, b, sizeof(b)); break; }
-        case 2: { int b[6][2]={{0,0},{-1,0},{0,-1},{-1,-1},{0,-2},{-1,-2}}; memcpy(body, b, sizeof(b)); break; }
-        case 3: { int b[6][2]={{0,0},{1,0},{2,0},{0,-1},{1,-1},{2,-1}}; memcpy(body, b, sizeof(b)); break; }
-    }
-}
+// live edit
+bool replannerReady = false;
+double lastReplanMs = 0;
 
-int CheckCarCollision(int x, int y, int mode) {
-    int body[6][2]; 
-    GetCarBody(mode, body);
-    for (int i = 0; i < 6; i++) {
-        int cx = x + body[i][0];
-        int cy = y + body[i][1];
-        if (cx < 0 || cx >= cols || cy < 0 || cy >= rows) return 0;
-        if (maze[cy][cx] == 0) return 0;
-    }
-    return 1;
-}
-
-int Dijkstra(int startX, int startY, int startMode, int targetX, int targetY, PathStep** outPath, int* outStepCount) {
-    size_t totalStates = (size_t)rows * cols * 4;
-    int *dist = (int*)malloc(totalStates * sizeof(int));
-    size_t *parent = (size_t*)malloc(totalStates * sizeof(size_t));
-    
-    for(size_t i=0; i<totalStates; i++) {
-        dist[i] = INT_MAX;
-        parent[i] = SIZE_MAX;
-    }
-
-    MinHeap* pq = createMinHeap(INIT_HEAP_CAPACITY);
-    size_t startIdx = IDX_POS(startY, startX, startMode, cols);
-    dist[startIdx] = 0;
-    pushHeap(pq, (PQNode){startX, startY, startMode, 0, 0});
-
-    int finalCost = -1;
-    size_t endStateIdx = SIZE_MAX;
-
-    while(pq->size > 0) {
-        PQNode u = popHeap(pq);
-        size_t uIdx = IDX_POS(u.y, u.x, u.mode, cols);
-        if(u.cost > dist[uIdx]) continue;
-        int body[6][2];
-        GetCarBody(u.mode, body);
-        bool hit = false;
-        for(int b=0; b<6; b++) {
-            if((u.x + body[b][0]) == targetX && (u.y + body[b][1]) == targetY) {
-                hit = true; break;
-            }
-        }
-        if(hit) {
-            finalCost = u.cost;
-            endStateIdx = uIdx;
-            break; 
-        }
-        for(int i=0; i<8; i++) {
-            int nextMode = Mode_Movement_Fuel[u.mode][i][0];
-            int dx = Mode_Movement_Fuel[u.mode][i][1];
-            int dy = Mode_Movement_Fuel[u.mode][i][2];
-            int fuel = Mode_Movement_Fuel[u.mode][i][3];
-            int nx = u.x + dx;
-            int ny = u.y + dy;
-
-            if(nx >= 0 && nx < cols && ny >= 0 && ny < rows && maze[ny][nx] != 0) {
-                if(CheckCarCollision(nx, ny, nextMode)) {
-                    int newCost = u.cost + fuel;
-                    size_t vIdx = IDX_POS(ny, nx, nextMode, cols);
-                    if(newCost < dist[vIdx]) {
-                        dist[vIdx] = newCost;
-                        parent[vIdx] = uIdx;
-                        pushHeap(pq, (PQNode){nx, ny, nextMode, 0, newCost});
-                    }
-                }
-            }
-        }
-    }
-
-    // reconstruct
-    if(outPath && outStepCount && finalCost != -1) {
-        PathStep tempBuff[2000]; 
-        int steps = 0;
-        size_t curr = endStateIdx;
-        while(curr != startIdx && curr != SIZE_MAX) {
-            int r = (curr / 4) / cols;
-            int c = (curr / 4) % cols;
-            int m = curr % 4;
-            tempBuff[steps++] = (PathStep){c, r, m};
-            curr = parent[curr];
-        } 
-        // reverse
-        *outStepCount = steps;
-        *outPath = (PathStep*)malloc(sizeof(PathStep) * steps);
-        for(int k = steps - 1; k >= 0; k--) {
-            (*outPath)[steps - 1 - k] = tempBuff[k];
-        }
-    }
-
-    free(dist);
-    free(parent);
-    freeHeap(pq);
-    return finalCost;
-}
+// static layers, drawn once into textures and redrawn only when stale
+RenderTexture2D titleTexture = {0};
+// maze texture: textureCell pixels per cell, or one texel per textureBlock x textureBlock
+// cells on mazes too large for MAZE_TEXTURE_MAX, mazePixels keeps the texels for edits
+Texture2D mazeTexture = {0};
+Color *mazePixels = NULL;
+int textureCell = 1, textureBlock = 1;
+bool mazeTextureStale = true;   // set when the maze changes
+int mazeTextureFilter = -1;
 
 // UI
-void DrawGradientTitle() {
-    const char *ascii_art[] = {
-        " ________  ________  _________  ___  ___  ________ ___  ________   ________  _______   ________   ",
-        "|\\   __  \\|\\   __  \\|\\___   ___\\\\  \\|\\  \\|\\  _____\\\\  \\|\\   ___  \\|\\   ___ \\|\\   ____\\|\\   __  \\  ",
-        "\\ \\  \\|\\  \\ \\  \\|\\  \\|___ \\  \\_\\ \\  \\\\\\  \\ \\  \\___| \\  \\ \\  \\\\ \\  \\ \\  \\_|\\ \\ \\  \\___|\\ \\  \\|\\  \\ ",
-        " \\ \\   ____\\ \\   __  \\   \\ \\  \\ \\ \\   __  \\ \\   __\\\\ \\  \\ \\  \\\\ \\  \\ \\  \\ \\\\ \\ \\   ____\\ \\   __  _\\",
-        "  \\ \\  \\___|\\ \\  \\ \\  \\   \\ \\  \\ \\ \\  \\ \\  \\ \\  \\_| \\ \\  \\ \\  \\\\ \\  \\ \\  \\_\\\\ \\ \\  \\___|\\ \\  \\ \\|",
-        "   \\ \\__\\    \\ \\__\\ \\__\\   \\ \\__\\ \\ \\__\\ \\__\\ \\__\\   \\ \\__\\ \\__\\\\ \\__\\ \\_______\\ \\_______\\ \\_\\ \\_\\",
-        "    \\ |__|     \\|__|\\|__|    \\|__|  \\|__|\\|__|\\|__|    \\|__|\\|__| \\|__|\\|_______|\\|_______|\\|_|\\|_|"
-    };
+static const char *ascii_art[] = {
+    " ________  ________  _________  ___  ___  ________ ___  ________   ________  _______   ________   ",
+    "|\\   __  \\|\\   __  \\|\\___   ___\\\\  \\|\\  \\|\\  _____\\\\  \\|\\   ___  \\|\\   ___ \\|\\   ____\\|\\   __  \\  ",
+    "\\ \\  \\|\\  \\ \\  \\|\\  \\|___ \\  \\_\\ \\  \\\\\\  \\ \\  \\___| \\  \\ \\  \\\\ \\  \\ \\  \\_|\\ \\ \\  \\___|\\ \\  \\|\\  \\ ",
+    " \\ \\   ____\\ \\   __  \\   \\ \\  \\ \\ \\   __  \\ \\   __\\\\ \\  \\ \\  \\\\ \\  \\ \\  \\ \\\\ \\ \\   ____\\ \\   __  _\\",
+    "  \\ \\  \\___|\\ \\  \\ \\  \\   \\ \\  \\ \\ \\  \\ \\  \\ \\  \\_| \\ \\  \\ \\  \\\\ \\  \\ \\  \\_\\\\ \\ \\  \\___|\\ \\  \\ \\|",
+    "   \\ \\__\\    \\ \\__\\ \\__\\   \\ \\__\\ \\ \\__\\ \\__\\ \\__\\   \\ \\__\\ \\__\\\\ \\__\\ \\_______\\ \\_______\\ \\_\\ \\_\\",
+    "    \\ |__|     \\|__|\\|__|    \\|__|  \\|__|\\|__|\\|__|    \\|__|\\|__| \\|__|\\|_______|\\|_______|\\|_|\\|_|"
+};
+// the gradient title is one DrawText per character, so it is drawn once into titleTexture
+void RenderTitleTexture() {
     Color startColor = {0, 100, 255, 255};
     Color endColor = {255, 140, 0, 255};
-    
     int artRows = sizeof(ascii_art) / sizeof(ascii_art[0]);
-    int fontSize = 16;
-    int charSpacing = 12;
-    int lineHeight = fontSize + 2;
-    
-    int TitletotalWidth = strlen(ascii_art[0]) * charSpacing;
-    int TitletotalHeight = artRows * lineHeight;
-    int startX = (screenWidth - TitletotalWidth) / 2;
-    int startY = (screenHeight - TitletotalHeight) / 2 - 80;
 
+    titleTexture = LoadRenderTexture(strlen(ascii_art[0]) * TITLE_CHAR_SPACING, artRows * TITLE_LINE_HEIGHT);
+    BeginTextureMode(titleTexture);
+    ClearBackground(BLANK);
     for (int i = 0; i < artRows; i++) {
         int len = strlen(ascii_art[i]);
         for (int j = 0; j < len; j++) {
@@ -294,9 +104,25 @@ void DrawGradientTitle() {
                 255
             };
             char tempStr[2] = { ascii_art[i][j], '\0' };
-            DrawText(tempStr, startX + (j * charSpacing), startY + (i * lineHeight), fontSize, drawColor);
+            DrawText(tempStr, j * TITLE_CHAR_SPACING, i * TITLE_LINE_HEIGHT, TITLE_FONT_SIZE, drawColor);
         }
     }
+    EndTextureMode();
+}
+
+// render textures are stored upside down, a negative source height flips them back
+void DrawRenderTexture(RenderTexture2D target, int x, int y) {
+    Rectangle source = {0, 0, (float)target.texture.width, -(float)target.texture.height};
+    DrawTextureRec(target.texture, source, (Vector2){(float)x, (float)y}, WHITE);
+}
+
+void DrawGradientTitle() {
+    int TitletotalWidth = titleTexture.texture.width;
+    int TitletotalHeight = titleTexture.texture.height;
+    int startX = (screenWidth - TitletotalWidth) / 2;
+    int startY = (screenHeight - TitletotalHeight) / 2 - 80;
+
+    DrawRenderTexture(titleTexture, startX, startY);
     currentY = startY + TitletotalHeight + 30;
 }
 
@@ -321,138 +147,194 @@ void DrawBlinkHint() {
     }
 }
 
-bool LoadMaze(const char *filename) {
-    rows = 0; cols = 0;
-    bool col_calculated = false;
-    int ch;
-    
-    FILE *inf = fopen(filename, "r");
-    if (inf == NULL) return false;
-    while (1) {
-        ch = fgetc(inf);
-        if (ch != '\n' && ch != EOF) {
-            if (!col_calculated && ch != ' ') cols++;
-        } else {
-            if (ch == EOF) {
-                if(cols > 0) rows++;
-                break;
+Color CellColor(int val) {
+    switch(val) {
+        case 0: return DARKGRAY;
+        case 1: return LIME;
+        case 2: return MAROON;
+        case 3: return BLUE;
+        default: return BLACK;
+    }
+}
+
+// whole maze centered in the window
+void FitMazeView() {
+    float zoomX = (float)(screenWidth - MAZE_DISPLAY_MARGIN * 2) / solver.cols;
+    float zoomY = (float)(screenHeight - MAZE_DISPLAY_MARGIN * 2) / solver.rows;
+    fitZoom = zoomX < zoomY ? zoomX : zoomY;
+    camera.offset = (Vector2){screenWidth * 0.5f, screenHeight * 0.5f};
+    camera.target = (Vector2){solver.cols * 0.5f, solver.rows * 0.5f};
+    camera.rotation = 0.0f;
+    camera.zoom = fitZoom;
+}
+
+// texels of block (bx, by) in mazePixels. A block covers textureBlock cells per side and
+// textureCell texels per side. Blocks that merge cells show an objective or the car when
+// they hold one, otherwise the average of their cells.
+void PaintMazeBlock(int bx, int by) {
+    int texWidth = (solver.cols + textureBlock - 1) / textureBlock * textureCell;
+    if (textureBlock == 1) {
+        Color c = CellColor(MAZE_AT(&solver, by, bx));
+        for (int py = 0; py < textureCell; py++) {
+            for (int px = 0; px < textureCell; px++) {
+                bool border = textureCell >= 4 && (px == 0 || py == 0 || px == textureCell - 1 || py == textureCell - 1);
+                mazePixels[(size_t)(by * textureCell + py) * texWidth + bx * textureCell + px] = border ? BLACK : c;
             }
-            if(!col_calculated) col_calculated = true;
-            rows++;
         }
+        return;
     }
-    maze = (int **)malloc(rows * sizeof(int *));
-    for (int i = 0; i < rows; i++) {
-        maze[i] = (int *)malloc(cols * sizeof(int));
-    }
-    rewind(inf);
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            if (fscanf(inf, "%1d", &maze[i][j]) != 1) maze[i][j] = 5;
-            if(maze[i][j] == 2) {
-                start_state.x = j;
-                start_state.y = i;
-                start_state.mode = 0;
-                if (j >= 2 && maze[i][j-1] == 2 && maze[i][j-2] == 2) {
-                    start_state.mode = 3;
-                    start_state.x = j-2;
-                } else if (j >= 1 && maze[i][j-1] == 2) {
-                    start_state.mode = 2;
-                }
-            }
+    int r = 0, g = 0, b = 0, n = 0, marker = -1;
+    for (int y = by * textureBlock; y < (by + 1) * textureBlock && y < solver.rows; y++) {
+        for (int x = bx * textureBlock; x < (bx + 1) * textureBlock && x < solver.cols; x++) {
+            int val = MAZE_AT(&solver, y, x);
+            if (val == 2 || (val == 3 && marker < 0)) marker = val;
+            Color c = CellColor(val);
+            r += c.r; g += c.g; b += c.b; n++;
         }
     }
-    fclose(inf);
-    return true;
+    Color c = marker >= 0 ? CellColor(marker) : (Color){(unsigned char)(r / n), (unsigned char)(g / n), (unsigned char)(b / n), 255};
+    mazePixels[(size_t)by * texWidth + bx] = c;
 }
 
-void DrawMazeGrid() {
-    if (!mazeLoaded || rows == 0 || cols == 0) {
-        DrawText("Error: Maze not loaded or empty.", 100, 100, 20, ORANGE);
-        return;
-    }
+// rebuilds mazeTexture when it is stale, called outside of BeginDrawing
+void RefreshMazeTexture() {
+    if (!mazeTextureStale || !mazeLoaded || solver.rows == 0 || solver.cols == 0) return;
+    int side = solver.rows > solver.cols ? solver.rows : solver.cols;
+    textureCell = MAZE_TEXTURE_MAX / side;
+    if (textureCell > MAZE_TEXTURE_CELL_MAX) textureCell = MAZE_TEXTURE_CELL_MAX;
+    if (textureCell < 1) textureCell = 1;
+    textureBlock = (side + MAZE_TEXTURE_MAX - 1) / MAZE_TEXTURE_MAX;
+    int blocksX = (solver.cols + textureBlock - 1) / textureBlock;
+    int blocksY = (solver.rows + textureBlock - 1) / textureBlock;
+
+    int texWidth = blocksX * textureCell, texHeight = blocksY * textureCell;
+
+    if (mazeTexture.id > 0) UnloadTexture(mazeTexture);
+    free(mazePixels);
+    mazePixels = (Color*)malloc((size_t)texWidth * texHeight * sizeof(Color));
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) PaintMazeBlock(bx, by);
+    }
+    Image image = {mazePixels, texWidth, texHeight, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    mazeTexture = LoadTextureFromImage(image);
+    mazeTextureFilter = -1;
+    mazeTextureStale = false;
+}
 
-    mazeDisplayMargin = 40;
-    availableWidth = screenWidth - (mazeDisplayMargin*2);
-    availableHeight = screenHeight - (mazeDisplayMargin*2);
-    cellSize = (availableWidth/cols < availableHeight/rows)? availableWidth/cols : availableHeight/rows; 
-    mazePixelWidth = cols * cellSize;
-    mazePixelHeight = rows * cellSize;
-    offsetX = (screenWidth-mazePixelWidth) / 2;
-    offsetY = (screenHeight-mazePixelHeight) / 2;
-
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            int val = maze[i][j];
-            int x = offsetX + j * cellSize;
-            int y = offsetY + i * cellSize;
-
-            Color c;
-            switch(val) {
-                case 0: c = DARKGRAY; break;
-                case 1: c = LIME; break;
-                case 2: c = MAROON; break;
-                case 3: c = BLUE; break;
-                default: c = BLACK;
-            }
+// one edited cell, without rebuilding the whole texture
+void RefreshMazeCell(int x, int y) {
+    if (mazeTextureStale || mazeTexture.id == 0) return;
+    int bx = x / textureBlock, by = y / textureBlock;
+    PaintMazeBlock(bx, by);
+    Color block[MAZE_TEXTURE_CELL_MAX * MAZE_TEXTURE_CELL_MAX];
+    for (int py = 0; py < textureCell; py++) {
+        memcpy(block + py * textureCell, mazePixels + (size_t)(by * textureCell + py) * mazeTexture.width + bx * textureCell,
+               textureCell * sizeof(Color));
+    }
+    Rectangle rec = {(float)(bx * textureCell), (float)(by * textureCell), (float)textureCell, (float)textureCell};
+    UpdateTextureRec(mazeTexture, rec, block);
+}
 
-            DrawRectangle(x, y, cellSize, cellSize, c);
-            DrawRectangleLines(x, y, cellSize, cellSize, BLACK);
-        }
-    }
-    DrawText(TextFormat("Maze input detected, maze size: %d(rows) x %d(columns)", rows, cols), 10, screenHeight - 30, 20, GRAY);
-    DrawText("PRESS [ENTER] TO CONFIRM MAZE MAP", 10, 10, 20, LIGHTGRAY);
+// cells in view, clamped to the maze: x, y are the first column and row, width and height the counts
+Rectangle VisibleCells() {
+    Vector2 topLeft = GetScreenToWorld2D((Vector2){0, 0}, camera);
+    Vector2 bottomRight = GetScreenToWorld2D((Vector2){(float)screenWidth, (float)screenHeight}, camera);
+    int x0 = topLeft.x < 0 ? 0 : (int)topLeft.x;
+    int y0 = topLeft.y < 0 ? 0 : (int)topLeft.y;
+    int x1 = bottomRight.x + 1 > solver.cols ? solver.cols : (int)bottomRight.x + 1;
+    int y1 = bottomRight.y + 1 > solver.rows ? solver.rows : (int)bottomRight.y + 1;
+    return (Rectangle){(float)x0, (float)y0, (float)(x1 > x0 ? x1 - x0 : 0), (float)(y1 > y0 ? y1 - y0 : 0)};
 }
 
-// accessibility check (BFS)
-void CheckAccessibility() {
-    q = createQueue(MAX_ROWS * MAX_COLS * 4);
-    objCount=0;
-    memset(visited, 0, sizeof(visited));
-    reachableCount = 0;
-    for(int r=0; r<rows; r++){
-        for(int c=0; c<cols; c++){
-            if(maze[r][c] == 3) {
-                objectives[objCount].x = c;
-                objectives[objCount].y = r;
-                objectives[objCount].reachable = false;
-                objCount++;
+// maze layer in world space, between BeginMode2D and EndMode2D. Zoomed in past the texture
+// resolution only the visible cells are drawn, which are few at that zoom; otherwise the
+// texture is scaled to the maze, so the frame cost does not grow with the maze.
+void DrawMazeLayer() {
+    if (camera.zoom > textureCell && camera.zoom >= MAZE_DETAIL_ZOOM) {
+        Rectangle view = VisibleCells();
+        float line = 1.0f / camera.zoom;
+        for (int i = (int)view.y; i < (int)(view.y + view.height); i++) {
+            for (int j = (int)view.x; j < (int)(view.x + view.width); j++) {
+                Rectangle cell = {(float)j, (float)i, 1.0f, 1.0f};
+                DrawRectangleRec(cell, CellColor(MAZE_AT(&solver, i, j)));
+                DrawRectangleLinesEx(cell, line, BLACK);
             }
         }
+        return;
     }
-    if (CheckCarCollision(start_state.x, start_state.y, start_state.mode)) {
-        visited[start_state.y][start_state.x][0] = true;
-        enqueue(q, start_state);
+    int filter = camera.zoom < textureCell ? TEXTURE_FILTER_BILINEAR : TEXTURE_FILTER_POINT;
+    if (filter != mazeTextureFilter) SetTextureFilter(mazeTexture, filter);
+    mazeTextureFilter = filter;
+    float worldScale = (float)textureBlock / textureCell;
+    Rectangle source = {0, 0, (float)mazeTexture.width, (float)mazeTexture.height};
+    Rectangle dest = {0, 0, mazeTexture.width * worldScale, mazeTexture.height * worldScale};
+    DrawTexturePro(mazeTexture, source, dest, (Vector2){0, 0}, 0.0f, WHITE);
+}
+
+// car body in world space
+void DrawCar(PathStep step) {
+    int body[6][2];
+    GetCarBody(step.m, body);
+    for (int i = 0; i < 6; i++) {
+        Rectangle cell = {step.x + body[i][0] + 0.1f, step.y + body[i][1] + 0.1f, 0.8f, 0.8f};
+        DrawRectangleRec(cell, (body[i][0] == 0 && body[i][1] == 0) ? DARKPURPLE : PURPLE);
     }
-    while (!isQueueEmpty(q)) {
-        State current = dequeue(q);
-        if (maze[current.y][current.x] == 3) {
-             for(int i=0; i<objCount; i++) {
-                if(objectives[i].x == current.x && objectives[i].y == current.y && !objectives[i].reachable) {
-                    objectives[i].reachable = true;
-                }
-            }
-        }
-        for (int i = 0; i < 8; i++) {
-            int nextMode = Mode_Movement_Fuel[current.mode][i][0];
-            int dx = Mode_Movement_Fuel[current.mode][i][1];
-            int dy = Mode_Movement_Fuel[current.mode][i][2];
-            int nx = current.x + dx;
-            int ny = current.y + dy;
-
-            if (nx < 0 || nx >= cols || ny < 0 || ny >= rows) continue;
-            if (!visited[ny][nx][nextMode] && CheckCarCollision(nx, ny, nextMode)) {
-                visited[ny][nx][nextMode] = true;
-                enqueue(q, (State){nx, ny, nextMode});
-            }
-        }
+}
+
+// wheel zooms at the cursor, the middle button or the arrow keys pan, [HOME] fits the
+// maze and [F] follows the car (car is NULL on screens without one)
+void UpdateMazeView(const PathStep *car) {
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0) {
+        Vector2 mouse = GetMousePosition();
+        Vector2 anchor = GetScreenToWorld2D(mouse, camera);
+        camera.zoom *= wheel > 0 ? 1.25f : 0.8f;
+        if (camera.zoom < fitZoom * 0.5f) camera.zoom = fitZoom * 0.5f;
+        if (camera.zoom > MAZE_ZOOM_MAX) camera.zoom = MAZE_ZOOM_MAX;
+        // keep the cell under the cursor in place unless the car is followed
+        if (!followCar) {
+            camera.offset = mouse;
+            camera.target = anchor;
+        }
+    }
+    Vector2 pan = {0, 0};
+    if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) pan = GetMouseDelta();
+    float step = VIEW_PAN_SPEED * GetFrameTime();
+    if (IsKeyDown(KEY_LEFT)) pan.x += step;
+    if (IsKeyDown(KEY_RIGHT)) pan.x -= step;
+    if (IsKeyDown(KEY_UP)) pan.y += step;
+    if (IsKeyDown(KEY_DOWN)) pan.y -= step;
+    if (pan.x != 0 || pan.y != 0) {
+        followCar = false;
+        camera.target.x -= pan.x / camera.zoom;
+        camera.target.y -= pan.y / camera.zoom;
+    }
+    if (IsKeyPressed(KEY_HOME)) { followCar = false; FitMazeView(); }
+    if (car && IsKeyPressed(KEY_F)) followCar = !followCar;
+    if (car && followCar) {
+        // ease towards the middle of the car's 2x3 body
+        int body[6][2];
+        GetCarBody(car->m, body);
+        Vector2 center = {0, 0};
+        for (int i = 0; i < 6; i++) { center.x += body[i][0]; center.y += body[i][1]; }
+        center = (Vector2){car->x + center.x / 6 + 0.5f, car->y + center.y / 6 + 0.5f};
+        camera.offset = (Vector2){screenWidth * 0.5f, screenHeight * 0.5f};
+        camera.target.x += (center.x - camera.target.x) * 0.2f;
+        camera.target.y += (center.y - camera.target.y) * 0.2f;
     }
-    for(int i=0; i<objCount; i++) {
-        if(objectives[i].reachable) reachableCount++;
-        else maze[objectives[i].y][objectives[i].x] = 1;
+}
+
+void DrawMazeGrid() {
+    if (!mazeLoaded || solver.rows == 0 || solver.cols == 0) {
+        DrawText("Error: Maze not loaded or empty.", 100, 100, 20, ORANGE);
+        return;
     }
 
-    freeQueue(q);
+    BeginMode2D(camera);
+        DrawMazeLayer();
+    EndMode2D();
+    DrawText(TextFormat("Maze input detected, maze size: %d(rows) x %d(columns)", solver.rows, solver.cols), 10, screenHeight - 30, 20, GRAY);
+    DrawText("PRESS [ENTER] TO CONFIRM MAZE MAP", 10, 10, 20, LIGHTGRAY);
 }
 
 void DrawAccessibilityResults() {
@@ -466,422 +348,188 @@ void DrawAccessibilityResults() {
     DrawText(title, (screenWidth - titleWidth)/2, 40, titleSize, SKYBLUE);
     DrawLine(100, 85, screenWidth-100, 85, DARKGRAY);
 
-    for(int i=0; i<objCount; i++) {
+    for(int i=0; i<solver.objCount; i++) {
         int posX = i%2 == 0 ? 150 : 700;
-        const char* status = objectives[i].reachable ? "ACCESSIBLE" : "UNREACHABLE";
-        Color statusColor = objectives[i].reachable ? LIME : RED;
+        const char* status = solver.objectives[i].reachable ? "ACCESSIBLE" : "UNREACHABLE";
+        Color statusColor = solver.objectives[i].reachable ? LIME : RED;
         
         char buffer[100];
-        sprintf(buffer, "Objective at (%d, %d): ", objectives[i].x, objectives[i].y);
+        sprintf(buffer, "Objective at (%d, %d): ", solver.objectives[i].x, solver.objectives[i].y);
         
         int textW = MeasureText(buffer, textSize);
         DrawText(buffer, posX, startY + (i/2*spacing), textSize, LIGHTGRAY);
         DrawText(status, posX + textW + 10, startY + (i/2*spacing), textSize, statusColor);
     }
 
-    int summaryY = startY + ((objCount/2+1) * spacing) + 40;
+    int summaryY = startY + ((solver.objCount/2+1) * spacing) + 40;
     DrawLine(100, summaryY - 20, screenWidth-100, summaryY - 20, DARKGRAY);
     
     char summary[100];
-    sprintf(summary, "SUMMARY: %d / %d objectives reachable.", reachableCount, objCount);
+    sprintf(summary, "SUMMARY: %d / %d objectives reachable.", solver.reachableCount, solver.objCount);
     DrawText(summary, 150, summaryY, 30, WHITE);
 
-    const char* prompt = "PRESS [ENTER] TO PLAY PATH";
+    if (solveCancelled) DrawText("SOLVE CANCELLED", 150, summaryY + 40, 30, ORANGE);
+
+    const char* prompt = (solvedTSP && solver.tspPath.count > 0) ? "PRESS [ENTER] TO PLAY PATH" : "PRESS [ENTER] TO EXIT";
     if (((int)(GetTime() * 2)) % 2 == 0) {
         DrawText(prompt, (screenWidth - MeasureText(prompt, 20))/2, screenHeight - 50, 20, GREEN);
     }
 }
 
-// Exact TSP (Bitmask Dijkstra)
-void DecodeIndex(size_t idx, int *r, int *c, int *m, int *mk, int cols, int maxMask) {
-    size_t temp = idx;
-    size_t stride_row = (size_t)cols * 4 * maxMask;
-    size_t stride_col = (size_t)4 * maxMask;
-    size_t stride_mode = (size_t)maxMask;
-
-    *r = (int)(temp / stride_row);
-    temp = temp % stride_row;
-    *c = (int)(temp / stride_col);
-    temp = temp % stride_col;
-    *m = (int)(temp / stride_mode);
-    *mk = (int)(temp % stride_mode);
-}
-
-void SolveTSP_Exact() {
-    printf("\n--- Starting Exact TSP (Reachable Only) ---\n");
-    ActiveTarget activeTargets[MAX_COLS * MAX_ROWS];
-    int activeCount = 0;
-
-    for (int i = 0; i < objCount; i++) {
-        if (objectives[i].reachable) {
-            activeTargets[activeCount].x = objectives[i].x;
-            activeTargets[activeCount].y = objectives[i].y;
-            activeTargets[activeCount].originalIdx = i;
-            activeCount++;
-        }
-    }
+void DrawSolveProgress() {
+    const char* title = "SOLVING";
+    DrawText(title, (screenWidth - MeasureText(title, 40))/2, 40, 40, SKYBLUE);
+    DrawLine(100, 85, screenWidth-100, 85, DARKGRAY);
 
-    if (activeCount == 0) { printf("No reachable objectives.\n"); return; }
-    if (tspDist) free(tspDist);
-    if (tspParent) free(tspParent);
-    if (tspPathTrace) { free(tspPathTrace); tspPathTrace = NULL; }
-    tspStepCount = 0;
-    int maxMask = (1 << activeCount);
-    size_t totalStates = (size_t)rows * cols * 4 * maxMask;
-    tspDist = (int*)malloc(totalStates * sizeof(int));
-    tspParent = (size_t*)malloc(totalStates * sizeof(size_t));
-
-    if (!tspDist || !tspParent) return;
-
-    for (size_t i = 0; i < totalStates; i++) {
-        tspDist[i] = INT_MAX;
-        tspParent[i] = SIZE_MAX;
+    int textY = 200;
+    DrawText(TextFormat("Phase: %s", SolverPhaseName(solveProgress.phase)), 150, textY, 24, WHITE);
+    if (solveProgress.total > 0) {
+        DrawText(TextFormat("Step: %d / %d", solveProgress.done, solveProgress.total), 150, textY + 35, 24, LIGHTGRAY);
     }
-    MinHeap* pq = createMinHeap(INIT_HEAP_CAPACITY);
-    int startMask = 0;
-    int startBody[6][2];
-    GetCarBody(start_state.mode, startBody);
-    for (int b = 0; b < 6; b++) {
-        int cx = start_state.x + startBody[b][0];
-        int cy = start_state.y + startBody[b][1];
-        for (int i = 0; i < activeCount; i++) {
-            if (activeTargets[i].x == cx && activeTargets[i].y == cy) {
-                startMask |= (1 << i);
-            }
-        }
+    DrawText(TextFormat("States settled: %zu", solveProgress.states), 150, textY + 70, 24, LIGHTGRAY);
+    if (solveProgress.bound >= 0) {
+        DrawText(TextFormat("Best bound: %d", solveProgress.bound), 150, textY + 105, 24, LIGHTGRAY);
     }
+    DrawText(TextFormat("Elapsed: %.1f s", GetTime() - solveStartTime), 150, textY + 140, 24, LIGHTGRAY);
 
-    size_t startIdx = GET_IDX(start_state.y, start_state.x, start_state.mode, startMask, cols, maxMask);
-    tspDist[startIdx] = 0;
-    pushHeap(pq, (PQNode){start_state.x, start_state.y, start_state.mode, startMask, 0});
-
-    size_t finalStateIdx = SIZE_MAX;
-    int finalMinCost = -1;
-    while (pq->size > 0) {
-        PQNode u = popHeap(pq);
-        size_t uIdx = GET_IDX(u.y, u.x, u.mode, u.mask, cols, maxMask);
-
-        if (u.cost > tspDist[uIdx]) continue;
-        if (u.mask == (maxMask - 1)) { // All targets visited
-            finalMinCost = u.cost;
-            finalStateIdx = uIdx;
-            break; 
-        }
-        for (int i = 0; i < 8; i++) {
-            int nextMode = Mode_Movement_Fuel[u.mode][i][0];
-            int dx = Mode_Movement_Fuel[u.mode][i][1];
-            int dy = Mode_Movement_Fuel[u.mode][i][2];
-            int fuel = Mode_Movement_Fuel[u.mode][i][3];
-            int nx = u.x + dx;
-            int ny = u.y + dy;
-
-            if (nx >= 0 && nx < cols && ny >= 0 && ny < rows && maze[ny][nx] != 0) {
-                if (CheckCarCollision(nx, ny, nextMode)) {
-                    int newCost = u.cost + fuel;
-                    int newMask = u.mask;
-
-                    int body[6][2];
-                    GetCarBody(nextMode, body);
-                    for (int b = 0; b < 6; b++) {
-                        int cx = nx + body[b][0];
-                        int cy = ny + body[b][1];
-                        for (int k = 0; k < activeCount; k++) {
-                            if (activeTargets[k].x == cx && activeTargets[k].y == cy) {
-                                newMask |= (1 << k);
-                            }
-                        }
-                    }
-
-                    size_t vIdx = GET_IDX(ny, nx, nextMode, newMask, cols, maxMask);
-                    if (newCost < tspDist[vIdx]) {
-                        tspDist[vIdx] = newCost;
-                        tspParent[vIdx] = uIdx;
-                        pushHeap(pq, (PQNode){nx, ny, nextMode, newMask, newCost});
-                    }
-                }
-            }
-        }
-    }
-
-    // Reconstruct
-    if (finalMinCost != -1) {
-        totalFuelCost = finalMinCost;
-        printf("SUCCESS: Optimal path found! Total Fuel: %d\n", finalMinCost);
-        
-        tspPathTrace = (PathStep*)malloc(sizeof(PathStep) * (rows * cols * 4 * activeCount)); 
-        int tempCount = 0;
-        size_t curr = finalStateIdx;
-
-        while (curr != SIZE_MAX) {
-            int r, c, m, mk;
-            DecodeIndex(curr, &r, &c, &m, &mk, cols, maxMask);
-            tspPathTrace[tempCount].x = c;
-            tspPathTrace[tempCount].y = r;
-            tspPathTrace[tempCount].m = m;
-            tempCount++;
-            curr = tspParent[curr];
-        }
-
-        // Reverse
-        for(int i=0; i<tempCount/2; i++) {
-            PathStep temp = tspPathTrace[i];
-            tspPathTrace[i] = tspPathTrace[tempCount - i - 1];
-            tspPathTrace[tempCount - i - 1] = temp;
-        }
-
-        tspStepCount = tempCount;
+    // bar fills with the phase steps, phases without a step count get a sliding block
+    int barX = 150, barY = textY + 200, barW = screenWidth - 300, barH = 30;
+    DrawRectangleLines(barX, barY, barW, barH, GRAY);
+    if (solveProgress.total > 0) {
+        int fillW = (int)((long long)(barW - 4) * solveProgress.done / solveProgress.total);
+        DrawRectangle(barX + 2, barY + 2, fillW, barH - 4, LIME);
     } else {
-        printf("FAILURE: Could not reach all active targets.\n");
+        int blockW = barW / 5;
+        float t = (float)(GetTime() * 0.5 - (int)(GetTime() * 0.5));
+        DrawRectangle(barX + 2 + (int)(t * (barW - 4 - blockW)), barY + 2, blockW, barH - 4, LIME);
     }
 
-    freeHeap(pq);
+    const char* prompt = "PRESS [C] TO CANCEL";
+    DrawText(prompt, (screenWidth - MeasureText(prompt, 20))/2, screenHeight - 50, 20, GRAY);
 }
 
-// Approx TSP (Christofides Algorithm)
-int GetSimpleDistance(int sx, int sy, int tx, int ty) {
-    int startMode = 0;
-    if(!CheckCarCollision(sx, sy, 0)) {
-        for(int m=0; m<4; m++) if(CheckCarCollision(sx, sy, m)) { startMode=m; break; }
+// phase timers and search counters of the last solve, toggled with [TAB]
+void DrawStatsOverlay() {
+    int panelW = 420, lineH = 20, fontSize = 16;
+    int lines = STATS_PHASE_COUNT + 6;
+    int panelX = screenWidth - panelW - 10, panelY = 50;
+    DrawRectangle(panelX, panelY, panelW, lines * lineH + 20, Fade(BLACK, 0.8f));
+    DrawRectangleLines(panelX, panelY, panelW, lines * lineH + 20, GRAY);
+
+    int x = panelX + 10, y = panelY + 10;
+    DrawText("PHASE              MS        KB", x, y, fontSize, YELLOW);
+    y += lineH;
+    for (int p = 0; p < STATS_PHASE_COUNT; p++) {
+        DrawText(statsPhaseName((StatsPhase)p), x, y, fontSize, LIGHTGRAY);
+        DrawText(TextFormat("%10.2f", solverStats.seconds[p] * 1e3), x + 150, y, fontSize, WHITE);
+        DrawText(TextFormat("%10zu", solverStats.bytes[p] >> 10), x + 260, y, fontSize, WHITE);
+        y += lineH;
+    }
+    y += lineH / 2;
+    const SearchCounters *kinds[2] = {&solverStats.dijkstra, &solverStats.exact};
+    const char *names[2] = {"dijkstra", "exact"};
+    for (int k = 0; k < 2; k++) {
+        const SearchCounters *c = kinds[k];
+        DrawText(TextFormat("%s: %zu searches, peak queue %zu", names[k], c->searches, c->queuePeak), x, y, fontSize, LIGHTGRAY);
+        y += lineH;
+        DrawText(TextFormat("  pops %zu, stale %zu, relax %zu", c->pops, c->stalePops, c->relaxations), x, y, fontSize, WHITE);
+        y += lineH;
     }
-    return Dijkstra(sx, sy, startMode, tx, ty, NULL, NULL);
 }
 
-void GetMST(int nodeCount, int *costMatrix, int *parentOut) {
-    int *key = (int*)malloc(nodeCount * sizeof(int));
-    bool *mstSet = (bool*)malloc(nodeCount * sizeof(bool));
-    for (int i = 0; i < nodeCount; i++) { key[i] = INT_MAX; mstSet[i] = false; }
-    key[0] = 0; parentOut[0] = -1;
-
-    for (int count = 0; count < nodeCount - 1; count++) {
-        int min = INT_MAX, u = -1;
-        for (int v = 0; v < nodeCount; v++) {
-            if (!mstSet[v] && key[v] < min) { min = key[v]; u = v; }
-        }
-        if (u == -1) break; 
-        mstSet[u] = true;
-        for (int v = 0; v < nodeCount; v++) {
-            int weight = costMatrix[u * nodeCount + v];
-            if (weight && !mstSet[v] && weight < key[v]) {
-                parentOut[v] = u; key[v] = weight;
-            }
-        }
-    }
-    free(key); free(mstSet);
-}
+// playback
+void DrawPathPlayback() {
+    DrawMazeGrid(); 
+    DrawRectangle(0, 0, screenWidth, 40, BLACK);
+    DrawText("PATH VISUALIZATION", 10, 10, 20, YELLOW);
 
-void FindEulerTour(int nodeCount, int *adjMatrix, int *circuit, int *circuitSize) {
-    int *stack = (int*)malloc(nodeCount * nodeCount * sizeof(int)); 
-    int top = 0;
-    stack[top] = 0;
-    int pathIdx = 0;
-    
-    int *tempAdj = (int*)malloc(nodeCount * nodeCount * sizeof(int));
-    memcpy(tempAdj, adjMatrix, nodeCount * nodeCount * sizeof(int));
-
-    while(top >= 0) {
-        int curr_v = stack[top];
-        int neighbor = -1;
-        for(int i=0; i<nodeCount; i++) {
-            if(tempAdj[curr_v * nodeCount + i] > 0) { neighbor = i; break; }
-        }
-        if(neighbor != -1) {
-            tempAdj[curr_v * nodeCount + neighbor]--;
-            tempAdj[neighbor * nodeCount + curr_v]--;
-            stack[++top] = neighbor;
-        } 
-        else {
-            circuit[pathIdx++] = stack[top--];
-        }
-    }
-    *circuitSize = pathIdx;
-    free(stack);
-    free(tempAdj);
-}
+    if (!solvedTSP || solver.tspPath.count == 0) return;
 
-int StitchPath(int startX, int startY, int startMode, int targetX, int targetY) {
-    PathStep* tempPath = NULL;
-    int tempStepCount = 0;
-    int cost = Dijkstra(startX, startY, startMode, targetX, targetY, &tempPath, &tempStepCount);
-
-    if(cost != -1 && tempPath) {
-        // stitch path to global trace
-        tspPathTrace = (PathStep*)realloc(tspPathTrace, sizeof(PathStep) * (tspStepCount + tempStepCount));
-        memcpy(tspPathTrace + tspStepCount, tempPath, sizeof(PathStep) * tempStepCount);
-        tspStepCount += tempStepCount;
-        free(tempPath);
+    if (playback.index < solver.tspPath.count) {
+        // draw vehicle
+        BeginMode2D(camera);
+            DrawCar(playback.step);
+        EndMode2D();
+        
+        DrawText(TextFormat("Step: %d / %d", playback.index + 1, solver.tspPath.count), 10, 40, 20, WHITE);
+        DrawText(TextFormat("Total Fuel Cost: %d", solver.totalFuelCost), 10, 70, 20, WHITE);
+    } else {
+        DrawText("Path Completed!", 10, 40, 20, GREEN);
     }
 
-    return cost;
+    const char* prompt = followCar ? "[F] FREE VIEW   [E] EDIT MAZE   [ENTER] EXIT" : "[F] FOLLOW CAR   [E] EDIT MAZE   [ENTER] EXIT";
+    DrawText(prompt, screenWidth - MeasureText(prompt, 20) - 20, 10, 20, GRAY);
 }
 
-void SolveTSP_Approx() {
-    printf("\n--- Starting Approximate TSP ---\n");
-    ActiveTarget activeTargets[MAX_COLS * MAX_ROWS];
-    int activeCount = 0;
-
-    for (int i = 0; i < objCount; i++) {
-        if (objectives[i].reachable) {
-            activeTargets[activeCount].x = objectives[i].x;
-            activeTargets[activeCount].y = objectives[i].y;
-            activeTargets[activeCount].originalIdx = i;
-            activeCount++;
-        }
-    }
-    if(activeCount == 0) return;
-
-    int numRealNodes = activeCount + 1; // add start
-    int totalNodes = numRealNodes + 1; // add dummy
-    ActiveTarget allNodes[MAX_COLS * MAX_ROWS];
-    allNodes[0].x = start_state.x; 
-    allNodes[0].y = start_state.y;
-    for(int i=0; i<activeCount; i++) allNodes[i+1] = activeTargets[i];
-    int *costMat = (int*)malloc(totalNodes * totalNodes * sizeof(int));
-    memset(costMat, 0, totalNodes * totalNodes * sizeof(int));
-    for(int i=0; i<numRealNodes; i++) {
-        for(int j=i+1; j<numRealNodes; j++) {
-            int c = GetSimpleDistance(allNodes[i].x, allNodes[i].y, allNodes[j].x, allNodes[j].y);
-            costMat[i*totalNodes + j] = c;
-            costMat[j*totalNodes + i] = c;
-        }
-    }
-    int dummy = totalNodes - 1;
-    costMat[0 * totalNodes + dummy] = 999999;
-    costMat[dummy * totalNodes + 0] = 999999;
-    for(int i=1; i<numRealNodes; i++) {
-        costMat[i * totalNodes + dummy] = 0;
-        costMat[dummy * totalNodes + i] = 0;
-    }
-
-    int *mstParent = (int*)malloc(totalNodes * sizeof(int));
-    GetMST(totalNodes, costMat, mstParent);
-
-    int *multiGraph = (int*)calloc(totalNodes * totalNodes, sizeof(int));
-    int *degrees = (int*)calloc(totalNodes, sizeof(int));
-    for(int i=1; i<totalNodes; i++) {
-        int u = i; int v = mstParent[i];
-        if(v != -1) {
-            multiGraph[u*totalNodes + v]++; 
-            multiGraph[v*totalNodes + u]++;
-            degrees[u]++; 
-            degrees[v]++;
-        }
-    }
-
-    int *odds = (int*)malloc(totalNodes * sizeof(int));
-    int oddCount = 0;
-    for(int i=0; i<totalNodes; i++) if(degrees[i] % 2 != 0) odds[oddCount++] = i;
-    
-    bool *matched = (bool*)calloc(totalNodes, sizeof(bool));
-    for(int i=0; i<oddCount; i++) {
-        int u = odds[i];
-        if(matched[u]) continue;
-        int minW = INT_MAX, bestV = -1;
-        for(int j=i+1; j<oddCount; j++) {
-            int v = odds[j];
-            if(!matched[v] && costMat[u*totalNodes + v] < minW) {
-                minW = costMat[u*totalNodes + v]; 
-                bestV = v;
-            }
-        }
-        if(bestV != -1) {
-            matched[u] = true; 
-            matched[bestV] = true;
-            multiGraph[u*totalNodes + bestV]++; 
-            multiGraph[bestV*totalNodes + u]++;
-        }
-    }
-
-    //  Euler tour
-    int *circuit = (int*)malloc(totalNodes * 2 * sizeof(int));
-    int circuitSize = 0;
-    FindEulerTour(totalNodes, multiGraph, circuit, &circuitSize);
-
-    // circuit is reversed
-
-    // extract TSP path (remove duplicates)
-    int *visitOrder = (int*)malloc(totalNodes * sizeof(int));
-    bool *visitedMap = (bool*)calloc(totalNodes, sizeof(bool));
-    int orderCount = 0;
-    for(int i=circuitSize-1; i>=0; i--) {
-        int node = circuit[i];
-        if(node == dummy) continue;
-        if(!visitedMap[node]) {
-            visitedMap[node] = true;
-            visitOrder[orderCount++] = node;
-        }
-    }
-
-    // stitch physical path
-    tspPathTrace = (PathStep*)malloc(sizeof(PathStep) * (rows * cols * 4 * activeCount * 5)); 
-    tspStepCount = 0;
-    totalFuelCost = 0;
-
-    int curX = start_state.x;
-    int curY = start_state.y;
-    int curM = start_state.mode;
-    tspPathTrace[tspStepCount++] = (PathStep){curX, curY, curM};
-
-    for(int i=1; i<orderCount; i++) {
-        int targetNodeIdx = visitOrder[i]; 
-        int tX = allNodes[targetNodeIdx].x;
-        int tY = allNodes[targetNodeIdx].y;
-        int legCost = StitchPath(curX, curY, curM, tX, tY);
-        
-        if(legCost != -1) {
-            totalFuelCost += legCost;
-            PathStep last = tspPathTrace[tspStepCount-1];
-            curX = last.x;
-            curY = last.y;
-            curM = last.m;
-        }
-    }
+// step the car stands on, NULL without a path
+const PathStep *PlaybackCar() {
+    if (!solvedTSP || playback.index >= solver.tspPath.count) return NULL;
+    return &playback.step;
+}
 
+// puts the car back on the first step of the path
+void RewindPlayback() {
+    PathCursorSeek(&playback, &solver, &solver.tspPath, 0);
+    playbackFrameCounter = 0;
+}
 
-    printf("Approximation Complete. Total Steps: %d, Cost: %d\n", tspStepCount, totalFuelCost);
+// maze cell under the mouse, false outside of the grid
+bool MouseCell(int *cx, int *cy) {
+    Vector2 world = GetScreenToWorld2D(GetMousePosition(), camera);
+    if (world.x < 0 || world.y < 0 || world.x >= solver.cols || world.y >= solver.rows) return false;
+    *cx = (int)world.x;
+    *cy = (int)world.y;
+    return true;
+}
 
-    free(costMat);
-    free(mstParent);
-    free(multiGraph);
-    free(degrees);
-    free(odds);
-    free(matched);
-    free(circuit);
-    free(visitOrder);
-    free(visitedMap);
+// left click toggles a wall, right click an objective, the path is re-planned after each edit
+void UpdateLiveEdit() {
+    if (!replannerReady) return;
+    int x, y;
+    int value = -1;
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && MouseCell(&x, &y)) value = MAZE_AT(&solver, y, x) == 0 ? 1 : 0;
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && MouseCell(&x, &y)) value = MAZE_AT(&solver, y, x) == 3 ? 1 : 3;
+    if (value < 0 || !SetMazeCell(&solver, x, y, value)) return;
+    RefreshMazeCell(x, y);
+
+    int objCount = solver.objCount;
+    double t0 = GetTime();
+    solvedTSP = Replan(&solver);
+    lastReplanMs = (GetTime() - t0) * 1e3;
+    if (solver.objCount != objCount) mazeTextureStale = true;     // unreachable objectives were cleared
+    replannerReady = solver.replanner != NULL;
+    RewindPlayback();
 }
 
-// playback
-void DrawPathPlayback() {
-    DrawMazeGrid(); 
+void DrawLiveEdit() {
+    DrawMazeGrid();
     DrawRectangle(0, 0, screenWidth, 40, BLACK);
-    DrawText("PATH VISUALIZATION", 10, 10, 20, YELLOW);
-
-    if (!solvedTSP || tspPathTrace == NULL || tspStepCount == 0) return;
-
-    int traceIndex = currentPlaybackStep;
-    if (traceIndex <= tspStepCount - 1) {
-        PathStep step = tspPathTrace[traceIndex];
-        int body[6][2];
-        GetCarBody(step.m, body);
-
-        // draw vehicle
-        for(int i=0; i<6; i++) {
-            int cx = step.x + body[i][0];
-            int cy = step.y + body[i][1];
-            int drawX = offsetX + cx * cellSize;
-            int drawY = offsetY + cy * cellSize;
-            
-            Color carColor = (body[i][0] == 0 && body[i][1] == 0) ? DARKPURPLE : PURPLE;
-            DrawRectangle(drawX + 2, drawY + 2, cellSize - 4, cellSize - 4, carColor);
-        }
-        
-        DrawText(TextFormat("Step: %d / %d", currentPlaybackStep + 1, tspStepCount), 10, 40, 20, WHITE);
-        DrawText(TextFormat("Total Fuel Cost: %d", totalFuelCost), 10, 70, 20, WHITE);
+    DrawText("LIVE EDIT", 10, 10, 20, YELLOW);
+    if (!replannerReady) {
+        DrawText("Replanner unavailable (out of memory)", 10, 40, 20, ORANGE);
+    } else if (solvedTSP && solver.tspPath.count > 0) {
+        // whole path as a line through the anchors, the car loops along it. Segments
+        // outside of the view are skipped.
+        Rectangle view = VisibleCells();
+        float thick = 2.0f / camera.zoom;
+        BeginMode2D(camera);
+        PathCursor line;
+        PathCursorSeek(&line, &solver, &solver.tspPath, 0);
+        for (PathStep a = line.step; PathCursorNext(&line); a = line.step) {
+            PathStep b = line.step;
+            if ((a.x < view.x - 2 && b.x < view.x - 2) || (a.x > view.x + view.width + 2 && b.x > view.x + view.width + 2)) continue;
+            if ((a.y < view.y - 2 && b.y < view.y - 2) || (a.y > view.y + view.height + 2 && b.y > view.y + view.height + 2)) continue;
+            DrawLineEx((Vector2){a.x + 0.5f, a.y + 0.5f}, (Vector2){b.x + 0.5f, b.y + 0.5f}, thick, GOLD);
+        }
+        if (PlaybackCar()) DrawCar(playback.step);
+        EndMode2D();
+        DrawText(TextFormat("Total Fuel Cost: %d   Objectives: %d / %d   Replan: %.2f ms", solver.totalFuelCost,
+                            solver.reachableCount, solver.objCount, lastReplanMs), 10, 40, 20, WHITE);
     } else {
-        DrawText("Path Completed!", 10, 40, 20, GREEN);
+        DrawText(TextFormat("No reachable objectives   Replan: %.2f ms", lastReplanMs), 10, 40, 20, ORANGE);
     }
 
-    const char* prompt = "PRESS [ENTER] TO EXIT";
+    const char* prompt = "[LMB] WALL  [RMB] OBJECTIVE  [WHEEL] ZOOM  [E] PLAYBACK";
     DrawText(prompt, screenWidth - MeasureText(prompt, 20) - 20, 10, 20, GRAY);
 }
 
@@ -889,37 +537,47 @@ int main(void) {
     SetConfigFlags(FLAG_VSYNC_HINT | FLAG_WINDOW_HIGHDPI);
     InitWindow(screenWidth, screenHeight, "Pathfinder GUI");
     
-    mazeLoaded = LoadMaze("input.txt");
+    SolverInit(&solver);
+    solver.verbose = true;
+    resetSolverStats(&solverStats);
+    solver.stats = &solverStats;
+    mazeLoaded = LoadMaze(&solver, "input.txt");
     AppScreen currentScreen = StartMenu;
+    RenderTitleTexture();
+    if (mazeLoaded) FitMazeView();
 
     while (!WindowShouldClose()) {
+        if (IsWindowResized() && mazeLoaded) FitMazeView();
+        if (IsKeyPressed(KEY_TAB)) showStats = !showStats;
         if (currentScreen == StartMenu) {
             if (IsKeyPressed(KEY_ENTER) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
                 currentScreen = MazeConfirm;
             }
         }
         else if (currentScreen == MazeConfirm) {
+            if (mazeLoaded) UpdateMazeView(NULL);
             if (IsKeyPressed(KEY_ENTER) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
                 currentScreen = AccessibilityCheck;
             }
         }
         else if (currentScreen == AccessibilityCheck) {
             if(!accessChecked) {
-                CheckAccessibility();
+                solveTask = StartSolveTask(&solver);
+                solveStartTime = GetTime();
                 accessChecked = true;
-                if (reachableCount > 0) {
-                    if (reachableCount < 15) SolveTSP_Exact();
-                    else SolveTSP_Approx();
-                } else {
-                    printf("No reachable objectives to solve.\n");
+            }
+            if (solveTask) {
+                if (IsKeyPressed(KEY_C)) CancelSolveTask(solveTask);
+                if (PollSolveTask(solveTask, &solveProgress)) {
+                    solvedTSP = FinishSolveTask(solveTask, &solveCancelled);
+                    solveTask = NULL;
+                    mazeTextureStale = true;    // unreachable objectives were cleared from the maze
                 }
-                solvedTSP = true;
             }
-            if (IsKeyPressed(KEY_ENTER)) {
-                if (solvedTSP && tspStepCount > 0) {
+            else if (IsKeyPressed(KEY_ENTER)) {
+                if (solvedTSP && solver.tspPath.count > 0) {
                     currentScreen = PathPlayback;
-                    currentPlaybackStep = 0;
-                    playbackFrameCounter = 0;
+                    RewindPlayback();
                     playbackFinished = false;
                 } else {
                     break;
@@ -927,17 +585,45 @@ int main(void) {
             }
         }
         else if (currentScreen == PathPlayback) {
+            UpdateMazeView(PlaybackCar());
             if (!playbackFinished) {
                 playbackFrameCounter++;
                 if (playbackFrameCounter >= PLAYBACK_FRAME_INTERVAL) {
-                    currentPlaybackStep = (currentPlaybackStep < tspStepCount - 1) ? currentPlaybackStep + 1 : currentPlaybackStep;
-                    playbackFinished = (currentPlaybackStep >= tspStepCount - 1);
+                    PathCursorNext(&playback);
+                    playbackFinished = (playback.index >= solver.tspPath.count - 1);
                     playbackFrameCounter = 0;
                 }
             }
-            if (IsKeyPressed(KEY_ENTER)) break;
+            if (IsKeyPressed(KEY_E)) {
+                // the first edit session grows a tree per objective, later ones reuse it
+                if (!replannerReady) {
+                    double t0 = GetTime();
+                    bool planned = StartReplanner(&solver);
+                    lastReplanMs = (GetTime() - t0) * 1e3;
+                    replannerReady = solver.replanner != NULL;
+                    if (replannerReady) solvedTSP = planned;
+                    mazeTextureStale = true;    // as after a solve, unreachable objectives are cleared
+                }
+                currentScreen = LiveEdit;
+                RewindPlayback();
+            }
+            else if (IsKeyPressed(KEY_ENTER)) break;
+        }
+        else if (currentScreen == LiveEdit) {
+            UpdateMazeView(PlaybackCar());
+            UpdateLiveEdit();
+            if (solvedTSP && solver.tspPath.count > 0 && ++playbackFrameCounter >= PLAYBACK_FRAME_INTERVAL) {
+                if (PathCursorNext(&playback)) playbackFrameCounter = 0;
+                else RewindPlayback();
+            }
+            if (IsKeyPressed(KEY_E)) {
+                currentScreen = PathPlayback;
+                RewindPlayback();
+                playbackFinished = false;
+            }
         }
 
+        if (currentScreen != StartMenu && !solveTask) RefreshMazeTexture();
         BeginDrawing();
             ClearBackground(BLACK);
             switch(currentScreen) {
@@ -947,17 +633,26 @@ int main(void) {
                     DrawBlinkHint();
                     break;
                 case MazeConfirm: DrawMazeGrid(); break;
-                case AccessibilityCheck: DrawAccessibilityResults(); break;
+                case AccessibilityCheck:
+                    if (solveTask) DrawSolveProgress();
+                    else DrawAccessibilityResults();
+                    break;
                 case PathPlayback: DrawPathPlayback(); break;
+                case LiveEdit: DrawLiveEdit(); break;
             }
+            // the solver thread writes the stats until the task is finished
+            if (showStats && !solveTask && currentScreen >= AccessibilityCheck) DrawStatsOverlay();
         EndDrawing();
     }
 
-    free(tspDist);
-    free(tspParent);
-    free(tspPathTrace);
-    for (int i = 0; i < rows; i++) free(maze[i]);
-    free(maze);
+    if (solveTask) {
+        CancelSolveTask(solveTask);
+        FinishSolveTask(solveTask, NULL);
+    }
+    SolverFree(&solver);
+    UnloadRenderTexture(titleTexture);
+    if (mazeTexture.id > 0) UnloadTexture(mazeTexture);
+    free(mazePixels);
     CloseWindow();
 
     return 0;
@@ -0,0 +1,231 @@
+#include "solver_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// Exact TSP (pose distance table + Held-Karp DP)
+//
+// The car visits a target when its body first covers the target cell, so a tour is
+// a chain of legs between poses that cover targets. dp[mask][p] is the cheapest walk
+// from the start that has covered the targets in mask and stands on pose p. Memory is
+// 2^k * poses, independent of the maze area.
+
+#define HK_INF (INT_MAX / 4)
+
+bool SolveTSP_HeldKarp(SolverContext *ctx) {
+    SOLVER_LOG(ctx, "\n--- Starting Held-Karp TSP ---\n");
+    int cols = ctx->cols;
+    State start = ctx->start_state;
+    ActiveTarget *activeTargets = (ActiveTarget*)malloc((ctx->objCount + 1) * sizeof(ActiveTarget));
+    int activeCount = CollectActiveTargets(ctx, activeTargets);
+
+    if (activeCount == 0) { SOLVER_LOG(ctx, "No reachable objectives.\n"); free(activeTargets); return false; }
+    if (activeCount > HELD_KARP_TARGET_LIMIT) {
+        SOLVER_LOG(ctx, "FAILURE: %d targets exceed the Held-Karp limit of %d.\n", activeCount, HELD_KARP_TARGET_LIMIT);
+        free(activeTargets);
+        return false;
+    }
+
+    // cover masks and the pose table searches run over the reachable poses only
+    const PoseIndex *index = &ctx->poseIndex;
+    size_t startId = index->bits ? DensePoseId(index, IDX_POS(start.y, start.x, start.mode, cols)) : POSE_NONE;
+    if (startId == POSE_NONE || !ListIndexPoses(ctx)) {
+        SOLVER_LOG(ctx, "FAILURE: no reachable pose index, run CheckAccessibility after editing the maze.\n");
+        free(activeTargets);
+        return false;
+    }
+    double statsStart = StatsStart(ctx);
+    size_t totalPoses = index->count;
+    uint32_t *coverMask = (uint32_t*)malloc(totalPoses * sizeof(uint32_t));
+    if (!coverMask) { free(activeTargets); return false; }
+    BuildDenseCoverMasks(ctx, activeTargets, activeCount, coverMask);
+    free(activeTargets);
+
+    // reachable poses that cover a target, index 0 is the start pose. The others are
+    // grouped by target (group activeCount holds poses covering several targets), so the
+    // DP only relaxes towards the groups of targets a mask still misses.
+    int poseCap = 1 + activeCount * 24;
+    State *poses = (State*)malloc(poseCap * sizeof(State));
+    size_t *poseIds = (size_t*)malloc(poseCap * sizeof(size_t));
+    uint32_t *poseCover = (uint32_t*)malloc(poseCap * sizeof(uint32_t));
+    int *groupStart = (int*)calloc(activeCount + 2, sizeof(int));
+    int poseCount = 0;
+    poses[poseCount] = start;
+    poseIds[poseCount] = startId;
+    poseCover[poseCount++] = coverMask[startId];
+    for (int g = 0; g <= activeCount; g++) {
+        groupStart[g] = poseCount;
+        for (size_t id = 0; id < totalPoses; id++) {
+            uint32_t cover = coverMask[id];
+            if (cover == 0 || id == startId) continue;
+            bool single = (cover & (cover - 1)) == 0;
+            if (g == activeCount ? single : cover != ((uint32_t)1 << g)) continue;
+            size_t p = index->pose[id];
+            poses[poseCount] = (State){(int)((p / 4) % cols), (int)((p / 4) / cols), (int)(p % 4)};
+            poseIds[poseCount] = id;
+            poseCover[poseCount++] = cover;
+        }
+    }
+    groupStart[activeCount + 1] = poseCount;
+    free(coverMask);
+
+    uint32_t maxMask = (uint32_t)1 << activeCount;
+    uint32_t fullMask = maxMask - 1;
+    uint32_t startMask = poseCover[0];
+    size_t P = (size_t)poseCount;
+    size_t dpBytes = (size_t)maxMask * P * sizeof(int);
+    double hkBytes = HeldKarpBytes(ctx, activeCount, P, totalPoses);
+    double hkSeconds = HeldKarpSeconds(activeCount, P, totalPoses);
+    if (dpBytes > HELD_KARP_MAX_BYTES || hkBytes > (double)SolverMemoryBudget(ctx)) {
+        SOLVER_LOG(ctx, "FAILURE: Held-Karp needs %.0f MB (%zu MB table).\n", hkBytes / (1 << 20), dpBytes >> 20);
+        free(poses); free(poseIds); free(poseCover); free(groupStart);
+        return false;
+    }
+    if (hkSeconds > HELD_KARP_MAX_SECONDS) {
+        SOLVER_LOG(ctx, "FAILURE: Held-Karp over %zu poses would take ~%.0f s.\n", P, hkSeconds);
+        free(poses); free(poseIds); free(poseCover); free(groupStart);
+        return false;
+    }
+
+    // pose to pose fuel costs, one full search per pose. Every pose here is reachable,
+    // so the searches share one slot numbering
+    const PoseIndex *dense = SearchPoseIndex(ctx, start);
+    if (!dense) {
+        for (size_t i = 0; i < P; i++) poseIds[i] = IDX_POS(poses[i].y, poses[i].x, poses[i].mode, cols);
+    }
+    size_t searchSlots = dense ? totalPoses : (size_t)ctx->rows * cols * 4;
+    int *D = (int*)malloc(P * P * sizeof(int));
+    int *dist = (int*)malloc(searchSlots * sizeof(int));
+    int *dp = (int*)malloc(dpBytes);
+    int *best = (int*)malloc(P * sizeof(int));
+    if (!D || !dist || !dp || !best) {
+        free(D); free(dist); free(dp); free(best); free(poses); free(poseIds); free(poseCover); free(groupStart);
+        return false;
+    }
+    ProgressPhase(ctx, PHASE_DISTANCES, poseCount);
+    bool cancelled = false;
+    for (size_t i = 0; i < P && !(cancelled = !ProgressStep(ctx)); i++) {
+        DijkstraAllSlots(ctx, poses[i], dense, dist);
+        for (size_t j = 0; j < P; j++) {
+            int d = dist[poseIds[j]];
+            D[i * P + j] = (d == INT_MAX) ? HK_INF : d;
+        }
+    }
+    free(dist);
+    free(poseIds);
+    StatsStop(ctx, STATS_POSE_TABLE, statsStart, totalPoses * sizeof(uint32_t) + searchSlots * sizeof(int) + P * P * sizeof(int));
+
+    statsStart = StatsStart(ctx);
+    for (size_t i = 0; i < (size_t)maxMask * P; i++) dp[i] = HK_INF;
+    dp[(size_t)startMask * P + 0] = 0;
+
+    ProgressPhase(ctx, PHASE_SEARCH, (int)(maxMask - startMask));
+    for (uint32_t mask = startMask; mask < maxMask && !(cancelled = !ProgressStep(ctx)); mask++) {
+        const int *row = dp + (size_t)mask * P;
+        bool live = false;
+        for (size_t q = 0; q < P; q++) best[q] = HK_INF;
+        for (size_t p = 0; p < P; p++) {
+            int base = row[p];
+            if (base >= HK_INF) continue;
+            live = true;
+            const int *d = D + p * P;
+            for (int g = 0; g <= activeCount; g++) {
+                if (g < activeCount && (mask >> g) & 1) continue;
+                for (int q = groupStart[g]; q < groupStart[g + 1]; q++) {
+                    int v = base + d[q];
+                    if (v < best[q]) best[q] = v;
+                }
+            }
+        }
+        if (!live) continue;
+        for (int g = 0; g <= activeCount; g++) {
+            if (g < activeCount && (mask >> g) & 1) continue;
+            for (int q = groupStart[g]; q < groupStart[g + 1]; q++) {
+                uint32_t nextMask = mask | poseCover[q];
+                if (nextMask == mask || best[q] >= HK_INF) continue;
+                int *cell = dp + (size_t)nextMask * P + q;
+                if (best[q] < *cell) *cell = best[q];
+            }
+        }
+    }
+
+    StatsStop(ctx, STATS_HELD_KARP_DP, statsStart, dpBytes + P * sizeof(int));
+
+    size_t endPose = 0;
+    int finalMinCost = HK_INF;
+    for (size_t q = 0; q < P && !cancelled; q++) {
+        int v = dp[(size_t)fullMask * P + q];
+        if (v < finalMinCost) { finalMinCost = v; endPose = q; }
+    }
+
+    bool solved = finalMinCost < HK_INF;
+    if (solved) {
+        // walk the DP back to the start, a predecessor mask lacks at least one bit of the pose cover
+        int *seq = (int*)malloc((activeCount + 1) * sizeof(int));
+        int seqCount = 0;
+        size_t cur = endPose;
+        uint32_t mask = fullMask;
+        int value = finalMinCost;
+        seq[seqCount++] = (int)cur;
+        while (!(cur == 0 && mask == startMask)) {
+            uint32_t need = mask & ~poseCover[cur];
+            uint32_t optional = mask & poseCover[cur];
+            bool found = false;
+            uint32_t sub = optional;
+            do {
+                sub = (sub - 1) & optional;
+                uint32_t prevMask = need | sub;
+                for (size_t p = 0; p < P && !found; p++) {
+                    int v = dp[(size_t)prevMask * P + p];
+                    if (v < HK_INF && v + D[p * P + cur] == value) {
+                        found = true;
+                        cur = p; mask = prevMask; value = v;
+                    }
+                }
+            } while (!found && sub != 0);
+            if (!found) break;
+            seq[seqCount++] = (int)cur;
+        }
+
+        // rebuild the physical path leg by leg
+        statsStart = StatsStart(ctx);
+        PathTrace *trace = &ctx->tspPath;
+        bool stitched = PathTraceStart(trace, (PathStep){start.x, start.y, start.mode});
+        for (int i = seqCount - 1; i > 0 && stitched; i--) {
+            State from = poses[seq[i]];
+            State to = poses[seq[i - 1]];
+            PathStep *leg = NULL;
+            int legSteps = 0;
+            stitched = DijkstraToPose(ctx, from.x, from.y, from.mode, to.x, to.y, to.mode, &leg, &legSteps) != -1
+                    && PathTraceAppend(ctx, trace, leg, legSteps);
+            free(leg);
+        }
+        free(seq);
+        StatsStop(ctx, STATS_STITCH, statsStart, PathTraceBytes(trace));
+
+        // a cancel or a failed leg leaves legs out of the trace, which is no tour
+        cancelled = SolveCancelled(ctx);
+        if (!stitched && !cancelled) SOLVER_LOG(ctx, "FAILURE: no leg from (%d, %d) on, the tour is incomplete.\n", trace->last.x, trace->last.y);
+        if (cancelled || !stitched) {
+            PathTraceFree(trace);
+            solved = false;
+        }
+    }
+    if (solved) {
+        ctx->totalFuelCost = finalMinCost;
+        ctx->engineUsed = TSP_HELD_KARP;
+        SOLVER_LOG(ctx, "SUCCESS: Optimal path found! Total Fuel: %d (%d poses, %zu MB table)\n", finalMinCost, poseCount, dpBytes >> 20);
+    } else if (cancelled) {
+        SOLVER_LOG(ctx, "Cancelled.\n");
+    } else {
+        SOLVER_LOG(ctx, "FAILURE: Could not reach all active targets.\n");
+    }
+
+    free(D);
+    free(dp);
+    free(best);
+    free(poses);
+    free(poseCover);
+    free(groupStart);
+    return solved;
+}
@@ -0,0 +1,416 @@
+#include "solver_internal.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Leg cache
+//
+// One shortest-path tree per target, grown over the reversed moves from every pose that
+// covers the target. Each settled pose keeps the move that leads on towards the target,
+// so the leg from any pose the car ends up in is a walk down the tree, and the tree
+// distances at the node anchors fill the cost matrix at the same time. A tree stops
+// growing once every anchor and every reachable pose covering a target is settled:
+// those are the only poses a leg starts from, and the tree path of a settled pose only
+// runs through settled poses.
+//
+// A cache that keeps its distances grows complete trees instead, so they can be
+// repaired in place when maze edits block or free poses (see RepairLegTrees).
+
+#define LEG_UNSEEN 0xFE     // never labelled by the tree search
+
+typedef struct {
+    int *dist;          // only used when the cache keeps no distances
+    PQueue *pq;
+    size_t *list;       // poses a repair unlabelled
+    size_t listCap;
+    SearchCounters counters;
+} LegTreeScratch;
+
+typedef struct {
+    const SolverContext *ctx;
+    LegCache *cache;
+    const ActiveTarget *nodes;
+    const State *anchors;
+    int nodeCount;
+    int *costMat;
+    int stride;
+    const uint64_t *stop;       // bit per pose: anchors and reachable covering poses, NULL grows complete trees
+    size_t stopCount;
+    LegTreeScratch *scratch;    // one per worker
+} LegTreeJob;
+
+static inline State PoseAt(size_t idx, int cols) {
+    return (State){(int)((idx / 4) % cols), (int)((idx / 4) / cols), (int)(idx % 4)};
+}
+
+size_t LegCacheBytes(const SolverContext *ctx, int targetCount, int workers, bool keepDist) {
+    size_t P = (size_t)ctx->rows * ctx->cols * 4;
+    if (keepDist) return (size_t)targetCount * P * (sizeof(int) + 1);
+    return (size_t)targetCount * P + (size_t)workers * P * sizeof(int) + (P + 63) / 64 * sizeof(uint64_t);
+}
+
+bool InitLegCache(const SolverContext *ctx, LegCache *cache, int targetCount, bool keepDist) {
+    memset(cache, 0, sizeof(*cache));
+    cache->count = targetCount;
+    cache->poseCount = (size_t)ctx->rows * ctx->cols * 4;
+    size_t trees = targetCount > 0 ? (size_t)targetCount : 1;
+    cache->next = (uint8_t*)malloc(trees * cache->poseCount);
+    if (keepDist) cache->dist = (int*)malloc(trees * cache->poseCount * sizeof(int));
+    if (!cache->next || (keepDist && !cache->dist)) { FreeLegCache(cache); return false; }
+    for (int m = 0; m < 4; m++) {
+        for (int pm = 0; pm < 4; pm++)
+            for (int i = 0; i < 8; i++)
+                if (ctx->moves[pm][i][0] == m) cache->reverse[m][cache->reverseCount[m]++] = ENCODE_PARENT(pm, i);
+    }
+    return true;
+}
+
+void FreeLegCache(LegCache *cache) {
+    free(cache->next);
+    free(cache->dist);
+    memset(cache, 0, sizeof(*cache));
+}
+
+static void FreeTreeScratch(LegTreeScratch *scratch) {
+    free(scratch->dist);
+    if (scratch->pq) freePQueue(scratch->pq);
+    free(scratch->list);
+    memset(scratch, 0, sizeof(*scratch));
+}
+
+// the distances of tree t, in the cache or in the worker scratch
+static int* TreeDist(const SolverContext *ctx, const LegCache *cache, int t, LegTreeScratch *scratch) {
+    if (!scratch->pq) scratch->pq = createSearchQueue(ctx);
+    if (cache->dist) return cache->dist + (size_t)t * cache->poseCount;
+    if (!scratch->dist) scratch->dist = (int*)malloc(cache->poseCount * sizeof(int));
+    return scratch->dist;
+}
+
+// settles tree t from scratch, until every stop pose is settled when stop is set
+static void GrowTree(const SolverContext *ctx, LegCache *cache, int t, int targetX, int targetY, LegTreeScratch *scratch, const uint64_t *stop, size_t stopCount) {
+    int cols = ctx->cols;
+    size_t P = cache->poseCount;
+    int *dist = TreeDist(ctx, cache, t, scratch);
+    uint8_t *next = cache->next + (size_t)t * P;
+    PQueue *pq = scratch->pq;
+    for (size_t i = 0; i < P; i++) dist[i] = INT_MAX;
+    memset(next, LEG_UNSEEN, P);
+    clearPQueue(pq);
+
+    int body[6][2];
+    for (int m = 0; m < 4; m++) {
+        GetCarBody(m, body);
+        for (int b = 0; b < 6; b++) {
+            int x = targetX - body[b][0], y = targetY - body[b][1];
+            if (!IsPoseFree(ctx, x, y, m)) continue;
+            size_t idx = IDX_POS(y, x, m, cols);
+            dist[idx] = 0;
+            next[idx] = PARENT_NONE;
+            pushPQueue(pq, (PQNode){x, y, m, 0, 0});
+        }
+    }
+
+    size_t remaining = stopCount;
+    size_t pops = 0, stalePops = 0, relaxations = 0;
+    int queuePeak = 0;
+    while (!isPQueueEmpty(pq)) {
+        if ((++pops & (PROGRESS_INTERVAL - 1)) == 0 && SolveCancelled(ctx)) break;
+        if (sizePQueue(pq) > queuePeak) queuePeak = sizePQueue(pq);
+        PQNode u = popPQueue(pq);
+        size_t uIdx = IDX_POS(u.y, u.x, u.mode, cols);
+        if (u.cost > dist[uIdx]) { stalePops++; continue; }
+        if (stop && ((stop[uIdx >> 6] >> (uIdx & 63)) & 1) && --remaining == 0) break;
+        for (int e = 0; e < cache->reverseCount[u.mode]; e++) {
+            uint8_t code = cache->reverse[u.mode][e];
+            int pm = PARENT_MODE(code);
+            const int *mv = ctx->moves[pm][PARENT_MOVE(code)];
+            int px = u.x - mv[1], py = u.y - mv[2];
+            if (!IsPoseFree(ctx, px, py, pm)) continue;
+            int newCost = u.cost + mv[3];
+            size_t pIdx = IDX_POS(py, px, pm, cols);
+            if (newCost < dist[pIdx]) {
+                dist[pIdx] = newCost;
+                next[pIdx] = (uint8_t)PARENT_MOVE(code);
+                pushPQueue(pq, (PQNode){px, py, pm, 0, newCost});
+                relaxations++;
+            } else if (newCost == dist[pIdx] && mv[3] > 0 && PARENT_MOVE(code) < next[pIdx]) {
+                next[pIdx] = (uint8_t)PARENT_MOVE(code);    // ties go to the lowest move, see LegMove
+            }
+        }
+    }
+    SearchCounters run = {1, pops, stalePops, relaxations, (size_t)queuePeak};
+    addSearchCounters(&scratch->counters, &run);
+}
+
+static void LegTree(void *arg, int t, int worker) {
+    LegTreeJob *job = (LegTreeJob*)arg;
+    const SolverContext *ctx = job->ctx;
+    LegTreeScratch *scratch = &job->scratch[worker];
+    if (SolveCancelled(ctx)) return;
+    const ActiveTarget *target = &job->nodes[t + 1];
+    GrowTree(ctx, job->cache, t, target->x, target->y, scratch, job->stop, job->stopCount);
+
+    // matrix entries towards this target from every earlier node, mirrored like the rows were
+    const int *dist = TreeDist(ctx, job->cache, t, scratch);
+    int j = t + 1;
+    for (int i = 0; i < j; i++) {
+        const State *a = &job->anchors[i];
+        int d = dist[IDX_POS(a->y, a->x, a->mode, ctx->cols)];
+        int c = d == INT_MAX ? LEG_COST_NONE : d;
+        job->costMat[i * job->stride + j] = c;
+        job->costMat[j * job->stride + i] = c;
+    }
+    ProgressStep(ctx);
+}
+
+// adds a reachable pose to the stop set, returns 1 when it was not in it yet
+static int MarkStop(const SolverContext *ctx, uint64_t *stop, size_t idx) {
+    if (!ctx->visited[idx] || ((stop[idx >> 6] >> (idx & 63)) & 1)) return 0;
+    stop[idx >> 6] |= (uint64_t)1 << (idx & 63);
+    return 1;
+}
+
+// merges the worker counters into the stats and frees the scratch
+static void FinishTreeScratch(SolverContext *ctx, const LegCache *cache, LegTreeScratch *scratch, int workers, StatsPhase phase) {
+    for (int w = 0; w < workers; w++) {
+        if (!scratch[w].pq) continue;
+        if (ctx->stats) {
+            addSearchCounters(&ctx->stats->dijkstra, &scratch[w].counters);
+            ctx->stats->bytes[phase] += (scratch[w].dist ? cache->poseCount * sizeof(int) : 0) + pqueueBytes(scratch[w].pq)
+                                      + scratch[w].listCap * sizeof(size_t);
+        }
+        FreeTreeScratch(&scratch[w]);
+    }
+    free(scratch);
+}
+
+// nodes[0] is the start and gets no tree, tree t belongs to nodes[t + 1]
+void BuildLegCache(SolverContext *ctx, LegCache *cache, const ActiveTarget *nodes, int nodeCount, const State *anchors, int *costMat, int stride) {
+    int cols = ctx->cols;
+    size_t P = cache->poseCount;
+    uint64_t *stop = NULL;
+    size_t stopCount = 0;
+    if (!cache->dist) {
+        stop = (uint64_t*)calloc((P + 63) / 64, sizeof(uint64_t));
+        for (int i = 0; i < nodeCount; i++) {
+            stopCount += MarkStop(ctx, stop, IDX_POS(anchors[i].y, anchors[i].x, anchors[i].mode, cols));
+            if (i == 0) continue;
+            int body[6][2];
+            for (int m = 0; m < 4; m++) {
+                GetCarBody(m, body);
+                for (int b = 0; b < 6; b++) {
+                    int x = nodes[i].x - body[b][0], y = nodes[i].y - body[b][1];
+                    if (IsPoseFree(ctx, x, y, m)) stopCount += MarkStop(ctx, stop, IDX_POS(y, x, m, cols));
+                }
+            }
+        }
+    }
+
+    ThreadPool *pool = GetSolverPool(ctx);
+    int workers = threadPoolSize(pool);
+    LegTreeJob job = {ctx, cache, nodes, anchors, nodeCount, costMat, stride, stop, stopCount, NULL};
+    job.scratch = (LegTreeScratch*)calloc(workers, sizeof(LegTreeScratch));
+
+    parallelFor(pool, cache->count, LegTree, &job);
+
+    FinishTreeScratch(ctx, cache, job.scratch, workers, STATS_MATRIX);
+    if (ctx->stats) ctx->stats->bytes[STATS_MATRIX] += LegCacheBytes(ctx, cache->count, 0, cache->dist != NULL);
+    free(stop);
+}
+
+// grows a complete tree for a target added after the build, returns its index or -1
+int AddLegTree(SolverContext *ctx, LegCache *cache, int targetX, int targetY) {
+    size_t P = cache->poseCount;
+    size_t trees = (size_t)cache->count + 1;
+    uint8_t *next = (uint8_t*)realloc(cache->next, trees * P);
+    if (!next) return -1;
+    cache->next = next;
+    if (cache->dist) {
+        int *dist = (int*)realloc(cache->dist, trees * P * sizeof(int));
+        if (!dist) return -1;
+        cache->dist = dist;
+    }
+    int t = cache->count++;
+    LegTreeScratch *scratch = (LegTreeScratch*)calloc(1, sizeof(LegTreeScratch));
+    GrowTree(ctx, cache, t, targetX, targetY, scratch, NULL, 0);
+    FinishTreeScratch(ctx, cache, scratch, 1, STATS_REPLAN);
+    return t;
+}
+
+// drops tree t, the last tree takes its index
+void RemoveLegTree(LegCache *cache, int t) {
+    size_t P = cache->poseCount;
+    int last = --cache->count;
+    if (t == last) return;
+    memcpy(cache->next + (size_t)t * P, cache->next + (size_t)last * P, P);
+    if (cache->dist) memcpy(cache->dist + (size_t)t * P, cache->dist + (size_t)last * P, P * sizeof(int));
+}
+
+typedef struct {
+    const SolverContext *ctx;
+    LegCache *cache;
+    const ActiveTarget *targets;
+    const size_t *changed;
+    int changedCount;
+    LegTreeScratch *scratch;    // one per worker
+} LegRepairJob;
+
+static void PushLost(LegTreeScratch *scratch, size_t *count, size_t idx) {
+    if (*count == scratch->listCap) {
+        scratch->listCap = scratch->listCap ? scratch->listCap * 2 : 256;
+        scratch->list = (size_t*)realloc(scratch->list, scratch->listCap * sizeof(size_t));
+    }
+    scratch->list[(*count)++] = idx;
+}
+
+// labels a free pose from its best labelled successor, or with 0 when it covers the target
+static void SeedPose(const SolverContext *ctx, const ActiveTarget *target, int *dist, uint8_t *next, PQueue *pq, size_t idx) {
+    State p = PoseAt(idx, ctx->cols);
+    int best = INT_MAX;
+    uint8_t code = PARENT_NONE;
+    if (PoseCoversCell(p.x, p.y, p.mode, target->x, target->y)) {
+        best = 0;
+    } else {
+        for (int i = 0; i < 8; i++) {
+            const int *mv = ctx->moves[p.mode][i];
+            if (!IsPoseFree(ctx, p.x + mv[1], p.y + mv[2], mv[0])) continue;
+            int d = dist[IDX_POS(p.y + mv[2], p.x + mv[1], mv[0], ctx->cols)];
+            if (d != INT_MAX && d + mv[3] < best) { best = d + mv[3]; code = (uint8_t)i; }
+        }
+    }
+    if (best < dist[idx]) {
+        dist[idx] = best;
+        next[idx] = code;
+        pushPQueue(pq, (PQNode){p.x, p.y, p.mode, 0, best});
+    }
+}
+
+// Blocked poses and every pose whose tree path ran through one lose their labels, then
+// those still free and the freed poses are seeded from their labelled successors. One
+// Dijkstra pass from the seeds settles what the edit changed and stops there: poses
+// off the damaged subtrees keep labels that are still shortest or get lowered.
+static void RepairTree(void *arg, int t, int worker) {
+    LegRepairJob *job = (LegRepairJob*)arg;
+    const SolverContext *ctx = job->ctx;
+    LegCache *cache = job->cache;
+    LegTreeScratch *scratch = &job->scratch[worker];
+    int cols = ctx->cols;
+    size_t P = cache->poseCount;
+    int *dist = TreeDist(ctx, cache, t, scratch);
+    uint8_t *next = cache->next + (size_t)t * P;
+    PQueue *pq = scratch->pq;
+    clearPQueue(pq);
+
+    size_t lost = 0;
+    for (int c = 0; c < job->changedCount; c++) {
+        size_t idx = job->changed[c];
+        State p = PoseAt(idx, cols);
+        if (IsPoseFree(ctx, p.x, p.y, p.mode) || next[idx] == LEG_UNSEEN) continue;
+        next[idx] = LEG_UNSEEN;
+        dist[idx] = INT_MAX;
+        PushLost(scratch, &lost, idx);
+    }
+    // children in the tree are the poses whose stored move leads into a lost pose
+    for (size_t h = 0; h < lost; h++) {
+        State u = PoseAt(scratch->list[h], cols);
+        for (int e = 0; e < cache->reverseCount[u.mode]; e++) {
+            uint8_t code = cache->reverse[u.mode][e];
+            const int *mv = ctx->moves[PARENT_MODE(code)][PARENT_MOVE(code)];
+            int vx = u.x - mv[1], vy = u.y - mv[2];
+            if ((unsigned)vx >= (unsigned)cols || (unsigned)vy >= (unsigned)ctx->rows) continue;
+            size_t vIdx = IDX_POS(vy, vx, PARENT_MODE(code), cols);
+            if (next[vIdx] != PARENT_MOVE(code)) continue;
+            next[vIdx] = LEG_UNSEEN;
+            dist[vIdx] = INT_MAX;
+            PushLost(scratch, &lost, vIdx);
+        }
+    }
+
+    const ActiveTarget *target = &job->targets[t];
+    for (size_t h = 0; h < lost; h++) {
+        State p = PoseAt(scratch->list[h], cols);
+        if (IsPoseFree(ctx, p.x, p.y, p.mode)) SeedPose(ctx, target, dist, next, pq, scratch->list[h]);
+    }
+    for (int c = 0; c < job->changedCount; c++) {
+        State p = PoseAt(job->changed[c], cols);
+        if (IsPoseFree(ctx, p.x, p.y, p.mode)) SeedPose(ctx, target, dist, next, pq, job->changed[c]);
+    }
+
+    size_t pops = 0, stalePops = 0, relaxations = 0;
+    int queuePeak = 0;
+    while (!isPQueueEmpty(pq)) {
+        pops++;
+        if (sizePQueue(pq) > queuePeak) queuePeak = sizePQueue(pq);
+        PQNode u = popPQueue(pq);
+        if (u.cost > dist[IDX_POS(u.y, u.x, u.mode, cols)]) { stalePops++; continue; }
+        for (int e = 0; e < cache->reverseCount[u.mode]; e++) {
+            uint8_t code = cache->reverse[u.mode][e];
+            int pm = PARENT_MODE(code);
+            const int *mv = ctx->moves[pm][PARENT_MOVE(code)];
+            int px = u.x - mv[1], py = u.y - mv[2];
+            if (!IsPoseFree(ctx, px, py, pm)) continue;
+            int newCost = u.cost + mv[3];
+            size_t pIdx = IDX_POS(py, px, pm, cols);
+            if (newCost < dist[pIdx]) {
+                dist[pIdx] = newCost;
+                next[pIdx] = (uint8_t)PARENT_MOVE(code);
+                pushPQueue(pq, (PQNode){px, py, pm, 0, newCost});
+                relaxations++;
+            }
+        }
+    }
+    SearchCounters run = {1, pops, stalePops, relaxations, (size_t)queuePeak};
+    addSearchCounters(&scratch->counters, &run);
+}
+
+// targets[t] is the target of tree t, poseFree already holds the edited maze
+void RepairLegTrees(SolverContext *ctx, LegCache *cache, const ActiveTarget *targets, const size_t *changed, int changedCount) {
+    if (changedCount == 0 || cache->count == 0) return;
+    ThreadPool *pool = GetSolverPool(ctx);
+    int workers = threadPoolSize(pool);
+    LegRepairJob job = {ctx, cache, targets, changed, changedCount, NULL};
+    job.scratch = (LegTreeScratch*)calloc(workers, sizeof(LegTreeScratch));
+    parallelFor(pool, cache->count, RepairTree, &job);
+    FinishTreeScratch(ctx, cache, job.scratch, workers, STATS_REPLAN);
+}
+
+int LegTreeDist(const SolverContext *ctx, const LegCache *cache, int t, State from) {
+    if (!IsPoseFree(ctx, from.x, from.y, from.mode)) return -1;
+    int d = cache->dist[(size_t)t * cache->poseCount + IDX_POS(from.y, from.x, from.mode, ctx->cols)];
+    return d == INT_MAX ? -1 : d;
+}
+
+// move tree t takes from pose s: the lowest paid move that keeps to a shortest path. A
+// fresh tree stores that move already; a repaired one may hold another move of the same
+// cost, so with distances it is picked again and every tree walks the same legs.
+static int LegMove(const SolverContext *ctx, const LegCache *cache, int t, State s) {
+    size_t idx = IDX_POS(s.y, s.x, s.mode, ctx->cols);
+    int stored = cache->next[(size_t)t * cache->poseCount + idx];
+    if (!cache->dist) return stored;
+    const int *dist = cache->dist + (size_t)t * cache->poseCount;
+    for (int i = 0; i < stored; i++) {
+        const int *mv = ctx->moves[s.mode][i];
+        if (mv[3] <= 0 || !IsPoseFree(ctx, s.x + mv[1], s.y + mv[2], mv[0])) continue;
+        int d = dist[IDX_POS(s.y + mv[2], s.x + mv[1], mv[0], ctx->cols)];
+        if (d != INT_MAX && d + mv[3] == dist[idx]) return i;
+    }
+    return stored;
+}
+
+// appends the leg from pose from (the last step of path) to tree t's target, -1 when from is not in the tree
+int WalkLeg(const SolverContext *ctx, const LegCache *cache, int t, State from, PathTrace *path) {
+    int cols = ctx->cols;
+    const uint8_t *next = cache->next + (size_t)t * cache->poseCount;
+    if (next[IDX_POS(from.y, from.x, from.mode, cols)] == LEG_UNSEEN) return -1;
+
+    // the tree holds move indices, they go into the trace as they are
+    int cost = 0;
+    for (State s = from; next[IDX_POS(s.y, s.x, s.mode, cols)] != PARENT_NONE;) {
+        int move = LegMove(ctx, cache, t, s);
+        const int *mv = ctx->moves[s.mode][move];
+        if (!PathTracePush(ctx, path, move)) return -1;
+        cost += mv[3];
+        s = (State){s.x + mv[1], s.y + mv[2], mv[0]};
+    }
+    return cost;
+}
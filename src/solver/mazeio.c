@@ -0,0 +1,265 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "solver_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Maze files
+//
+// Text: one line per row, one digit per cell (0 wall, 1 free, 2 car, 3 objective),
+// spaces and CR are ignored, blank lines are skipped and short rows are padded with 5.
+// Binary: MazeFileHeader, targetCount {x, y} pairs, then rows*cols cell bytes. Every
+// field is a 32-bit value in host byte order, so the cell block is copied as is. The
+// header's start pose and target list win over the car and objective cells of the grid.
+
+#define MAZE_FILE_MAGIC "PFMZ"
+#define MAZE_FILE_VERSION 1
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t rows, cols;
+    int32_t startX, startY, startMode;
+    uint32_t targetCount;
+} MazeFileHeader;
+
+typedef struct {
+    const char *data;
+    size_t size;
+#ifdef _WIN32
+    char *buffer;
+#endif
+} MappedFile;
+
+// read-only view of a whole file, mmap where available
+static bool MapFile(const char *filename, MappedFile *file) {
+    memset(file, 0, sizeof(*file));
+#ifdef _WIN32
+    FILE *inf = fopen(filename, "rb");
+    if (inf == NULL) return false;
+    fseek(inf, 0, SEEK_END);
+    long size = ftell(inf);
+    fseek(inf, 0, SEEK_SET);
+    if (size <= 0) { fclose(inf); return false; }
+    file->buffer = (char*)malloc((size_t)size);
+    if (!file->buffer || fread(file->buffer, 1, (size_t)size, inf) != (size_t)size) {
+        free(file->buffer);
+        fclose(inf);
+        return false;
+    }
+    fclose(inf);
+    file->data = file->buffer;
+    file->size = (size_t)size;
+    return true;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    file->data = (const char*)data;
+    file->size = (size_t)st.st_size;
+    return true;
+#endif
+}
+
+static void UnmapFile(MappedFile *file) {
+#ifdef _WIN32
+    free(file->buffer);
+#else
+    if (file->data) munmap((void*)file->data, file->size);
+#endif
+    memset(file, 0, sizeof(*file));
+}
+
+static void InstallMaze(SolverContext *ctx, uint8_t *maze, int rows, int cols, State start) {
+    StopReplanner(ctx);     // its trees and the reachable poses belong to the old maze
+    FreePoseIndex(&ctx->poseIndex);
+    free(ctx->visited);
+    ctx->visited = NULL;
+    ctx->objCount = ctx->reachableCount = 0;
+    free(ctx->maze);
+    ctx->maze = maze;
+    ctx->rows = rows;
+    ctx->cols = cols;
+    ctx->start_state = start;
+    BuildPoseTable(ctx);
+}
+
+static bool IsBlank(char ch) { return ch == ' ' || ch == '\r' || ch == '\t'; }
+
+// single pass over the text, the grid grows by whole rows
+static bool ParseTextMaze(SolverContext *ctx, const char *data, size_t size) {
+    const char *p = data, *end = data + size;
+    int rows = 0, cols = 0;
+    size_t capacity = 0;
+    uint8_t *maze = NULL;
+    State start = {-1, -1, 0};      // set by the car (2) cells
+
+    while (p < end) {
+        const char *eol = (const char*)memchr(p, '\n', (size_t)(end - p));
+        if (eol == NULL) eol = end;
+
+        if (cols == 0) {
+            // the first non-blank line fixes the width
+            for (const char *q = p; q < eol; q++) if (!IsBlank(*q)) cols++;
+            if (cols > 0) {
+                capacity = size / ((size_t)cols + 1) + 1;
+                maze = (uint8_t*)malloc(capacity * cols);
+                if (!maze) return false;
+            }
+        }
+
+        int n = 0;
+        uint8_t *row = maze ? maze + (size_t)rows * cols : NULL;
+        for (const char *q = p; q < eol; q++) {
+            char ch = *q;
+            if (IsBlank(ch)) continue;
+            if (ch < '0' || ch > '9' || n >= cols) { free(maze); return false; }
+            uint8_t val = (uint8_t)(ch - '0');
+            row[n] = val;
+            if (val == 2) {
+                start = (State){n, rows, 0};
+                if (n >= 2 && row[n-1] == 2 && row[n-2] == 2) {
+                    start.mode = 3;
+                    start.x = n-2;
+                } else if (n >= 1 && row[n-1] == 2) {
+                    start.mode = 2;
+                }
+            }
+            n++;
+        }
+        p = eol + 1;
+        if (n == 0) continue;
+        memset(row + n, 5, (size_t)(cols - n));
+        rows++;
+
+        if ((size_t)rows == capacity && p < end) {
+            capacity *= 2;
+            uint8_t *grown = (uint8_t*)realloc(maze, capacity * cols);
+            if (!grown) { free(maze); return false; }
+            maze = grown;
+        }
+    }
+    if (rows == 0 || start.x < 0) {
+        SOLVER_LOG(ctx, "Maze rejected: %s.\n", rows == 0 ? "no rows" : "no car (2) cell");
+        free(maze);
+        return false;
+    }
+
+    InstallMaze(ctx, maze, rows, cols, start);
+    return true;
+}
+
+static bool ParseBinaryMaze(SolverContext *ctx, const char *data, size_t size) {
+    MazeFileHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != MAZE_FILE_VERSION || header.rows == 0 || header.cols == 0) return false;
+    if (header.rows > INT32_MAX || header.cols > INT32_MAX || header.startMode < 0 || header.startMode > 3) return false;
+    if (header.startX < 0 || header.startY < 0 || (uint32_t)header.startX >= header.cols || (uint32_t)header.startY >= header.rows) return false;
+
+    size_t cells = (size_t)header.rows * header.cols;
+    size_t targetBytes = (size_t)header.targetCount * 2 * sizeof(uint32_t);
+    if (cells / header.cols != header.rows || targetBytes / 8 != header.targetCount) return false;
+    if (size - sizeof(header) < targetBytes || size - sizeof(header) - targetBytes < cells) return false;
+
+    int rows = (int)header.rows, cols = (int)header.cols;
+    State start = {header.startX, header.startY, header.startMode};
+    const char *targetData = data + sizeof(header);
+    uint8_t *maze = (uint8_t*)malloc(cells);
+    if (!maze) return false;
+    memcpy(maze, targetData + targetBytes, cells);
+
+    // the target list is authoritative, so objective cells the list leaves out are cleared
+    size_t carCells = 0;
+    for (size_t i = 0; i < cells; i++) {
+        if (maze[i] == 3) maze[i] = 1;
+        else if (maze[i] == 2) carCells++;
+    }
+
+    // the start pose has to be a legal car pose. A grid with car (2) cells has to hold
+    // exactly its body; a plain grid gets the body drawn in, as the text format has it.
+    int body[6][2];
+    GetCarBody(start.mode, body);
+    bool legal = true;
+    for (int b = 0; b < 6 && legal; b++) {
+        int x = start.x + body[b][0], y = start.y + body[b][1];
+        legal = x >= 0 && x < cols && y >= 0 && y < rows && maze[(size_t)y * cols + x] != 0
+             && (carCells == 0 || maze[(size_t)y * cols + x] == 2);
+    }
+    if (!legal || (carCells != 0 && carCells != 6)) {
+        SOLVER_LOG(ctx, "Maze rejected: the start pose (%d, %d) mode %d %s.\n", start.x, start.y, start.mode,
+                   legal ? "does not match the car (2) cells" : "is not a free car pose");
+        free(maze);
+        return false;
+    }
+    for (int b = 0; b < 6; b++) maze[(size_t)(start.y + body[b][1]) * cols + start.x + body[b][0]] = 2;
+
+    for (uint32_t t = 0; t < header.targetCount; t++) {
+        uint32_t xy[2];
+        memcpy(xy, targetData + (size_t)t * sizeof(xy), sizeof(xy));
+        if (xy[0] >= header.cols || xy[1] >= header.rows) { free(maze); return false; }
+        maze[(size_t)xy[1] * cols + xy[0]] = 3;
+    }
+
+    InstallMaze(ctx, maze, rows, cols, start);
+    return true;
+}
+
+bool LoadMazeFromMemory(SolverContext *ctx, const char *data, size_t size) {
+    if (size >= 4 && memcmp(data, MAZE_FILE_MAGIC, 4) == 0) return ParseBinaryMaze(ctx, data, size);
+    return ParseTextMaze(ctx, data, size);
+}
+
+bool LoadMaze(SolverContext *ctx, const char *filename) {
+    double statsStart = StatsStart(ctx);
+    MappedFile file;
+    if (!MapFile(filename, &file)) return false;
+    bool loaded = LoadMazeFromMemory(ctx, file.data, file.size);
+    UnmapFile(&file);
+    if (loaded) {
+        size_t cells = (size_t)ctx->rows * ctx->cols;
+        StatsStop(ctx, STATS_LOAD, statsStart, cells + (cells * 4 + 63) / 64 * sizeof(uint64_t));
+    }
+    return loaded;
+}
+
+bool SaveMazeBinary(const SolverContext *ctx, const char *filename) {
+    if (!ctx->maze) return false;
+    size_t cells = (size_t)ctx->rows * ctx->cols;
+    MazeFileHeader header;
+    memcpy(header.magic, MAZE_FILE_MAGIC, 4);
+    header.version = MAZE_FILE_VERSION;
+    header.rows = (uint32_t)ctx->rows;
+    header.cols = (uint32_t)ctx->cols;
+    header.startX = ctx->start_state.x;
+    header.startY = ctx->start_state.y;
+    header.startMode = ctx->start_state.mode;
+    header.targetCount = 0;
+    for (size_t i = 0; i < cells; i++) if (ctx->maze[i] == 3) header.targetCount++;
+
+    FILE *outf = fopen(filename, "wb");
+    if (outf == NULL) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, outf) == 1;
+    for (size_t i = 0; i < cells && ok; i++) {
+        if (ctx->maze[i] != 3) continue;
+        uint32_t xy[2] = {(uint32_t)(i % ctx->cols), (uint32_t)(i / ctx->cols)};
+        ok = fwrite(xy, sizeof(xy), 1, outf) == 1;
+    }
+    if (ok) ok = fwrite(ctx->maze, 1, cells, outf) == cells;
+    if (fclose(outf) != 0) ok = false;
+    return ok;
+}
@@ -0,0 +1,111 @@
+#include "solver.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Packed path trace
+//
+// A tour is stored as the start pose plus one 3-bit move index per step, so a step costs
+// under half a byte instead of a PathStep. Poses are decoded on the fly by replaying the
+// moves; a pose every PATH_MARK_STEPS steps bounds the replay for random access.
+
+static inline PathStep ApplyMove(const int (*moves)[8][4], PathStep s, int move) {
+    const int *mv = moves[s.m][move];
+    return (PathStep){s.x + mv[1], s.y + mv[2], mv[0]};
+}
+
+static inline int CodeAt(const PathTrace *trace, int k) {
+    return (int)(trace->codes[k / PATH_CODES_PER_WORD] >> (3 * (k % PATH_CODES_PER_WORD))) & 7;
+}
+
+bool PathTraceStart(PathTrace *trace, PathStep start) {
+    if (trace->markCap == 0) {
+        trace->marks = (PathStep*)malloc(sizeof(PathStep));
+        if (!trace->marks) return false;
+        trace->markCap = 1;
+    }
+    trace->marks[0] = start;
+    trace->last = start;
+    trace->count = 1;
+    return true;
+}
+
+bool PathTracePush(const SolverContext *ctx, PathTrace *trace, int move) {
+    if (trace->count == 0) return false;
+    int k = trace->count - 1;   // code index of the new step
+    int word = k / PATH_CODES_PER_WORD;
+    int mark = trace->count / PATH_MARK_STEPS;
+    bool marked = trace->count % PATH_MARK_STEPS == 0;
+    if (word == trace->codeCap) {
+        int cap = trace->codeCap ? trace->codeCap * 2 : 64;
+        uint64_t *codes = (uint64_t*)realloc(trace->codes, (size_t)cap * sizeof(uint64_t));
+        if (!codes) return false;
+        trace->codes = codes;
+        trace->codeCap = cap;
+    }
+    if (marked && mark == trace->markCap) {
+        int cap = trace->markCap * 2;
+        PathStep *marks = (PathStep*)realloc(trace->marks, (size_t)cap * sizeof(PathStep));
+        if (!marks) return false;
+        trace->marks = marks;
+        trace->markCap = cap;
+    }
+
+    if (k % PATH_CODES_PER_WORD == 0) trace->codes[word] = 0;
+    trace->codes[word] |= (uint64_t)move << (3 * (k % PATH_CODES_PER_WORD));
+    trace->last = ApplyMove(ctx->moves, trace->last, move);
+    if (marked) trace->marks[mark] = trace->last;
+    trace->count++;
+    return true;
+}
+
+bool PathTraceAppend(const SolverContext *ctx, PathTrace *trace, const PathStep *steps, int count) {
+    for (int k = 0; k < count; k++) {
+        PathStep from = trace->last;
+        int move = 0;
+        while (move < 8) {
+            const int *mv = ctx->moves[from.m][move];
+            if (mv[0] == steps[k].m && from.x + mv[1] == steps[k].x && from.y + mv[2] == steps[k].y) break;
+            move++;
+        }
+        if (move == 8 || !PathTracePush(ctx, trace, move)) return false;
+    }
+    return true;
+}
+
+void PathTraceFree(PathTrace *trace) {
+    free(trace->codes);
+    free(trace->marks);
+    memset(trace, 0, sizeof(*trace));
+}
+
+size_t PathTraceBytes(const PathTrace *trace) {
+    return (size_t)trace->codeCap * sizeof(uint64_t) + (size_t)trace->markCap * sizeof(PathStep);
+}
+
+PathStep PathTraceAt(const SolverContext *ctx, const PathTrace *trace, int index) {
+    PathCursor cursor;
+    if (!PathCursorSeek(&cursor, ctx, trace, index)) return (PathStep){-1, -1, -1};
+    return cursor.step;
+}
+
+bool PathCursorSeek(PathCursor *cursor, const SolverContext *ctx, const PathTrace *trace, int index) {
+    cursor->trace = trace;
+    cursor->moves = ctx->moves;
+    if (index < 0 || index >= trace->count) {
+        cursor->index = trace->count;
+        return false;
+    }
+    int k = index / PATH_MARK_STEPS * PATH_MARK_STEPS;
+    PathStep s = trace->marks[k / PATH_MARK_STEPS];
+    for (; k < index; k++) s = ApplyMove(ctx->moves, s, CodeAt(trace, k));
+    cursor->index = index;
+    cursor->step = s;
+    return true;
+}
+
+bool PathCursorNext(PathCursor *cursor) {
+    if (cursor->index + 1 >= cursor->trace->count) return false;
+    cursor->step = ApplyMove(cursor->moves, cursor->step, CodeAt(cursor->trace, cursor->index));
+    cursor->index++;
+    return true;
+}
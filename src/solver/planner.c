@@ -0,0 +1,162 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "solver_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// Engine planner
+//
+// Estimates the peak memory and a rough time for every engine from the maze size, the
+// reachable poses and the target count, then picks the exact engine that fits the memory
+// budget with the lowest time, or the approximation when none fits. The byte figures
+// follow the allocations of each solver. The times use per-state costs measured with
+// the benchmark and only serve to rank the engines.
+
+#define PLAN_NS_POSE_STATE 100.0    // one pose settled by a Dijkstra search
+#define PLAN_NS_EXACT_STATE 1500.0  // one (pose, mask) state settled by the exact search
+#define PLAN_NS_DP_STEP 1.0         // one Held-Karp relaxation
+
+// bytes of physical memory not in use, 0 when the platform cannot tell
+size_t GetAvailableMemory(void) {
+#ifdef _WIN32
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    return GlobalMemoryStatusEx(&status) ? (size_t)status.ullAvailPhys : 0;
+#else
+    // MemAvailable counts reclaimable page cache, the sysconf figure does not
+    FILE *inf = fopen("/proc/meminfo", "r");
+    if (inf) {
+        char line[128];
+        unsigned long long kb = 0;
+        while (fgets(line, sizeof(line), inf)) {
+            if (sscanf(line, "MemAvailable: %llu kB", &kb) == 1) break;
+        }
+        fclose(inf);
+        if (kb > 0) return (size_t)(kb << 10);
+    }
+#ifdef _SC_AVPHYS_PAGES
+    long pages = sysconf(_SC_AVPHYS_PAGES), pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0) return (size_t)pages * (size_t)pageSize;
+#endif
+    return 0;
+#endif
+}
+
+// every allocation SolveTSP_HeldKarp holds: the cover masks, the pose lists, one search's
+// dist array and queue (a node per slot at most), the pose table, the DP and its row scratch
+double HeldKarpBytes(const SolverContext *ctx, int k, size_t coverPoses, size_t reachable) {
+    size_t totalPoses = (size_t)ctx->rows * ctx->cols * 4;
+    size_t searchSlots = reachable * DENSE_SEARCH_RATIO <= totalPoses ? reachable : totalPoses;
+    double masks = k < 63 ? (double)((uint64_t)1 << k) : 0;
+    double P = (double)coverPoses;
+    return (double)reachable * sizeof(uint32_t) + P * (sizeof(State) + sizeof(size_t) + sizeof(uint32_t) + sizeof(int))
+         + (double)searchSlots * (sizeof(int) + sizeof(PQNode)) + P * P * sizeof(int) + masks * P * sizeof(int);
+}
+
+// one full search per table pose, then up to 2^k * P * P relaxations in the DP
+double HeldKarpSeconds(int k, size_t coverPoses, size_t reachable) {
+    double masks = k < 63 ? (double)((uint64_t)1 << k) : 0;
+    double P = (double)coverPoses;
+    return (P * (double)reachable * PLAN_NS_POSE_STATE + masks * P * P * PLAN_NS_DP_STEP) * 1e-9;
+}
+
+size_t SolverMemoryBudget(const SolverContext *ctx) {
+    size_t available = GetAvailableMemory() / 4 * 3;
+    if (ctx->memoryBudget == 0) return available ? available : SIZE_MAX;
+    return (available && available < ctx->memoryBudget) ? available : ctx->memoryBudget;
+}
+
+void PlanSolve(const SolverContext *ctx, SolvePlan *plan) {
+    memset(plan, 0, sizeof(*plan));
+    size_t P = (size_t)ctx->rows * ctx->cols * 4;
+    int k = ctx->reachableCount;
+    size_t workers = (size_t)(ctx->workerCount > 0 ? ctx->workerCount : GetCpuCount());
+    plan->budget = SolverMemoryBudget(ctx);
+    plan->targets = k;
+
+    // reachable poses, and the reachable poses covering each target (Held-Karp's table rows)
+    size_t reachable = 0, coverPoses = 1;
+    if (ctx->poseIndex.bits) reachable = ctx->poseIndex.count;
+    else if (ctx->visited) for (size_t i = 0; i < P; i++) reachable += ctx->visited[i];
+    for (int t = 0; t < ctx->objCount; t++) {
+        const Objective *o = &ctx->objectives[t];
+        if (!o->reachable) continue;
+        int body[6][2];
+        for (int m = 0; m < 4; m++) {
+            GetCarBody(m, body);
+            for (int b = 0; b < 6; b++) {
+                int x = o->x - body[b][0], y = o->y - body[b][1];
+                if ((unsigned)x < (unsigned)ctx->cols && (unsigned)y < (unsigned)ctx->rows && ctx->visited[IDX_POS(y, x, m, ctx->cols)]) coverPoses++;
+            }
+        }
+    }
+    plan->reachablePoses = reachable;
+
+    // exact bitmask search, dense store: dist/parent over every (reachable pose, mask) state
+    // plus cover masks and A* tables over the reachable poses
+    double masks = k < 63 ? (double)((uint64_t)1 << k) : 0;
+    double states = (double)reachable * masks;
+    double exactBytes = states * (sizeof(int) + 1) + (double)reachable * sizeof(uint32_t) + (double)k * reachable * sizeof(int) + masks * sizeof(int);
+    plan->bytes[TSP_EXACT] = exactBytes < (double)SIZE_MAX ? (size_t)exactBytes : SIZE_MAX;
+    plan->seconds[TSP_EXACT] = (double)reachable * masks * PLAN_NS_EXACT_STATE * 1e-9;
+
+    // Held-Karp: the pose table searches and the DP, see HeldKarpBytes
+    double dpBytes = masks * coverPoses * sizeof(int);
+    double hkBytes = HeldKarpBytes(ctx, k, coverPoses, reachable);
+    plan->bytes[TSP_HELD_KARP] = hkBytes < (double)SIZE_MAX ? (size_t)hkBytes : SIZE_MAX;
+    plan->seconds[TSP_HELD_KARP] = HeldKarpSeconds(k, coverPoses, reachable);
+
+    // approx: a leg cache tree per target when it fits, the legs are then walks. Without
+    // it the matrix row scratch per worker, then the two-sided leg buffers.
+    size_t matrixBytes = (size_t)(k + 2) * (k + 2) * 4 * sizeof(int);
+    size_t cacheBytes = LegCacheBytes(ctx, k, (int)workers, false);
+    if (cacheBytes <= plan->budget) {
+        plan->bytes[TSP_APPROX] = cacheBytes + matrixBytes;
+        plan->seconds[TSP_APPROX] = (double)k * reachable * PLAN_NS_POSE_STATE * 1e-9 / (double)workers;
+    } else {
+        plan->bytes[TSP_APPROX] = workers * P * (sizeof(int) + sizeof(int) / 4) + P * 2 * (sizeof(int) + 1) + matrixBytes;
+        plan->seconds[TSP_APPROX] = (double)(k + 1) * reachable * PLAN_NS_POSE_STATE * 1e-9 / (double)workers + (double)k * reachable * PLAN_NS_POSE_STATE * 0.5e-9;
+    }
+
+    // the exact engines compete on their estimates, the fastest that fits wins. Only the
+    // bitmask search keeps a target count limit: its A* bound is what makes it usable,
+    // and the bytes of the dense store say nothing about the hash store it falls back to.
+    plan->engine = TSP_APPROX;
+    plan->store = STORE_AUTO;
+    if (k > 0) {
+        bool hkFits = k <= HELD_KARP_TARGET_LIMIT && dpBytes <= (double)HELD_KARP_MAX_BYTES && plan->bytes[TSP_HELD_KARP] <= plan->budget
+                   && plan->seconds[TSP_HELD_KARP] <= HELD_KARP_MAX_SECONDS;
+        bool exactAllowed = k < EXACT_TARGET_LIMIT;
+        bool denseFits = exactAllowed && plan->bytes[TSP_EXACT] <= plan->budget;
+        if (hkFits && (!denseFits || plan->seconds[TSP_HELD_KARP] <= plan->seconds[TSP_EXACT])) {
+            plan->engine = TSP_HELD_KARP;
+        } else if (denseFits) {
+            plan->engine = TSP_EXACT;
+            plan->store = STORE_DENSE;
+        } else if (exactAllowed) {
+            // A* usually settles a small share of the states, so try it with the hash
+            // store capped at the budget before settling for the approximation
+            plan->engine = TSP_EXACT;
+            plan->store = STORE_HASH;
+        }
+    }
+}
+
+void LogSolvePlan(const SolverContext *ctx, const SolvePlan *plan) {
+    SOLVER_LOG(ctx, "\n--- Engine plan: %d targets, %zu reachable poses, budget %zu MB ---\n",
+               plan->targets, plan->reachablePoses, plan->budget == SIZE_MAX ? 0 : plan->budget >> 20);
+    for (int e = TSP_EXACT; e <= TSP_APPROX; e++) {
+        SOLVER_LOG(ctx, "  %-9s ~%zu MB, ~%.2f s%s\n", TSPEngineName((TSPEngine)e), plan->bytes[e] >> 20, plan->seconds[e],
+                   plan->bytes[e] > plan->budget ? " (over budget)" : "");
+    }
+    SOLVER_LOG(ctx, "  chosen: %s%s\n", TSPEngineName(plan->engine),
+               plan->engine == TSP_EXACT ? (plan->store == STORE_HASH ? " (hash store, capped at the budget)" : " (dense store)") : "");
+}
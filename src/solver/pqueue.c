@@ -0,0 +1,66 @@
+#include "pqueue.h"
+
+#define INIT_BUCKET_CAPACITY 64
+
+void initMinHeap(MinHeap *h, int capacity) {
+    h->nodes = (PQNode*)malloc(sizeof(PQNode) * capacity);
+    h->size = 0;
+    h->capacity = capacity;
+}
+void resizeHeap(MinHeap *h) {
+    h->capacity *= 2;
+    h->nodes = (PQNode*)realloc(h->nodes, sizeof(PQNode) * h->capacity);
+}
+void freeMinHeap(MinHeap *h) { free(h->nodes); h->nodes = NULL; h->size = h->capacity = 0; }
+
+void initBucketQueue(BucketQueue *bq, int maxWeight) {
+    bq->bucketCount = maxWeight + 1;
+    bq->buckets = (Bucket*)calloc(bq->bucketCount, sizeof(Bucket));
+    bq->cursor = 0;
+    bq->size = 0;
+}
+void resizeBucket(Bucket *b) {
+    b->capacity = b->capacity ? b->capacity * 2 : INIT_BUCKET_CAPACITY;
+    b->items = (PQNode*)realloc(b->items, sizeof(PQNode) * b->capacity);
+}
+void freeBucketQueue(BucketQueue *bq) {
+    for (int i = 0; i < bq->bucketCount; i++) free(bq->buckets[i].items);
+    free(bq->buckets);
+    bq->buckets = NULL;
+    bq->bucketCount = bq->size = 0;
+}
+
+PQueue* createPQueue(PQEngine engine, int maxWeight) {
+    PQueue *pq = (PQueue*)calloc(1, sizeof(PQueue));
+    if (engine == PQ_AUTO) engine = (maxWeight <= BUCKET_MAX_WEIGHT) ? PQ_BUCKET : PQ_HEAP;
+    pq->engine = engine;
+    if (engine == PQ_BUCKET) initBucketQueue(&pq->bq, maxWeight);
+    else initMinHeap(&pq->heap, INIT_HEAP_CAPACITY);
+    return pq;
+}
+// empties the queue but keeps its memory for the next search
+void clearPQueue(PQueue *pq) {
+    if (pq->engine == PQ_BUCKET) {
+        for (int i = 0; i < pq->bq.bucketCount; i++) pq->bq.buckets[i].size = 0;
+        pq->bq.cursor = 0;
+        pq->bq.size = 0;
+    } else {
+        pq->heap.size = 0;
+    }
+}
+// memory held by the queue, including capacity not in use
+size_t pqueueBytes(const PQueue *pq) {
+    size_t bytes = sizeof(PQueue);
+    if (pq->engine == PQ_BUCKET) {
+        bytes += (size_t)pq->bq.bucketCount * sizeof(Bucket);
+        for (int i = 0; i < pq->bq.bucketCount; i++) bytes += (size_t)pq->bq.buckets[i].capacity * sizeof(PQNode);
+    } else {
+        bytes += (size_t)pq->heap.capacity * sizeof(PQNode);
+    }
+    return bytes;
+}
+void freePQueue(PQueue *pq) {
+    if (pq->engine == PQ_BUCKET) freeBucketQueue(&pq->bq);
+    else freeMinHeap(&pq->heap);
+    free(pq);
+}
@@ -0,0 +1,123 @@
+#ifndef PATHFINDER_PQUEUE_H
+#define PATHFINDER_PQUEUE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define INIT_HEAP_CAPACITY 4000
+
+// largest edge weight the bucket queue is used for, above it the heap takes over
+#define BUCKET_MAX_WEIGHT 64
+
+typedef struct {
+    int x, y;
+    int mode;
+    int mask;   // bitmask
+    int cost;
+} PQNode;
+
+// binary heap, works for any non-negative cost
+typedef struct {
+    PQNode *nodes;
+    int size;
+    int capacity;
+} MinHeap;
+
+// Dial's circular bucket queue, keys of live nodes lie in [cursor, cursor + maxWeight]
+typedef struct {
+    PQNode *items;
+    int size;
+    int capacity;
+} Bucket;
+typedef struct {
+    Bucket *buckets;
+    int bucketCount;    // maxWeight + 1
+    int cursor;         // cost of the bucket popped last
+    int size;
+} BucketQueue;
+
+typedef enum {
+    PQ_AUTO = 0,
+    PQ_HEAP,
+    PQ_BUCKET
+} PQEngine;
+
+// priority queue used by the searches, dispatches to one of the engines above
+typedef struct {
+    PQEngine engine;
+    MinHeap heap;
+    BucketQueue bq;
+} PQueue;
+
+void initMinHeap(MinHeap *h, int capacity);
+void resizeHeap(MinHeap *h);
+void freeMinHeap(MinHeap *h);
+
+void initBucketQueue(BucketQueue *bq, int maxWeight);
+void resizeBucket(Bucket *b);
+void freeBucketQueue(BucketQueue *bq);
+
+// engine is PQ_HEAP or PQ_BUCKET, maxWeight is the largest edge weight pushed relative to the last pop
+PQueue* createPQueue(PQEngine engine, int maxWeight);
+void clearPQueue(PQueue *pq);
+void freePQueue(PQueue *pq);
+size_t pqueueBytes(const PQueue *pq);
+
+static inline void pushHeap(MinHeap *h, PQNode n) {
+    if (h->size == h->capacity) resizeHeap(h);
+    int i = h->size++;
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (h->nodes[p].cost <= n.cost) break;
+        h->nodes[i] = h->nodes[p];
+        i = p;
+    }
+    h->nodes[i] = n;
+}
+static inline PQNode popHeap(MinHeap *h) {
+    PQNode ret = h->nodes[0];
+    PQNode n = h->nodes[--h->size];
+    int i = 0;
+    while (i * 2 + 1 < h->size) {
+        int a = i * 2 + 1;
+        int b = i * 2 + 2;
+        if (b < h->size && h->nodes[b].cost < h->nodes[a].cost) a = b;
+        if (h->nodes[a].cost >= n.cost) break;
+        h->nodes[i] = h->nodes[a];
+        i = a;
+    }
+    h->nodes[i] = n;
+    return ret;
+}
+
+static inline void pushBucket(BucketQueue *bq, PQNode n) {
+    Bucket *b = &bq->buckets[n.cost % bq->bucketCount];
+    if (b->size == b->capacity) resizeBucket(b);
+    b->items[b->size++] = n;
+    bq->size++;
+}
+static inline PQNode popBucket(BucketQueue *bq) {
+    Bucket *b = &bq->buckets[bq->cursor % bq->bucketCount];
+    while (b->size == 0) {
+        bq->cursor++;
+        b = &bq->buckets[bq->cursor % bq->bucketCount];
+    }
+    bq->size--;
+    return b->items[--b->size];
+}
+
+static inline bool isPQueueEmpty(const PQueue *pq) {
+    return pq->engine == PQ_BUCKET ? pq->bq.size == 0 : pq->heap.size == 0;
+}
+static inline int sizePQueue(const PQueue *pq) {
+    return pq->engine == PQ_BUCKET ? pq->bq.size : pq->heap.size;
+}
+static inline void pushPQueue(PQueue *pq, PQNode n) {
+    if (pq->engine == PQ_BUCKET) pushBucket(&pq->bq, n);
+    else pushHeap(&pq->heap, n);
+}
+static inline PQNode popPQueue(PQueue *pq) {
+    return pq->engine == PQ_BUCKET ? popBucket(&pq->bq) : popHeap(&pq->heap);
+}
+
+#endif
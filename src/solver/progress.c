@@ -0,0 +1,148 @@
+#include "solver_internal.h"
+#include "systhread.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Solve tasks
+//
+// A SolveTask runs CheckAccessibility and SolveTSP on a thread of its own. The solvers
+// publish progress through ctx->monitor at phase changes, per unit of work and every
+// PROGRESS_INTERVAL settled states. The same calls read the cancel flag, and a solver
+// that sees it unwinds through its normal cleanup. Without a monitor every call is a
+// pointer test. Builds with SOLVER_NO_THREADS solve inside StartSolveTask instead, so
+// the caller blocks until the solve is done and cannot cancel it.
+
+struct SolverMonitor {
+#ifndef SOLVER_NO_THREADS
+    SysMutex lock;
+#endif
+    SolverProgress progress;
+    bool cancel;
+    bool finished;
+};
+
+struct SolveTask {
+    SolverContext *ctx;
+    SolverMonitor monitor;
+    bool solved;
+#ifndef SOLVER_NO_THREADS
+    SysThread thread;
+    bool threaded;      // false when the solve ran inside StartSolveTask
+#endif
+};
+
+#ifdef SOLVER_NO_THREADS
+#define MONITOR_LOCK(m) ((void)0)
+#define MONITOR_UNLOCK(m) ((void)0)
+#else
+#define MONITOR_LOCK(m) lockMutex(&(m)->lock)
+#define MONITOR_UNLOCK(m) unlockMutex(&(m)->lock)
+#endif
+
+void ProgressPhase(const SolverContext *ctx, SolverPhase phase, int total) {
+    SolverMonitor *m = ctx->monitor;
+    if (!m) return;
+    MONITOR_LOCK(m);
+    m->progress.phase = phase;
+    m->progress.states = 0;
+    m->progress.done = 0;
+    m->progress.total = total;
+    MONITOR_UNLOCK(m);
+}
+
+bool ProgressTick(const SolverContext *ctx, size_t states, int bound) {
+    SolverMonitor *m = ctx->monitor;
+    if (!m) return true;
+    MONITOR_LOCK(m);
+    m->progress.states = states;
+    m->progress.bound = bound;
+    bool go = !m->cancel;
+    MONITOR_UNLOCK(m);
+    return go;
+}
+
+bool ProgressStep(const SolverContext *ctx) {
+    SolverMonitor *m = ctx->monitor;
+    if (!m) return true;
+    MONITOR_LOCK(m);
+    m->progress.done++;
+    bool go = !m->cancel;
+    MONITOR_UNLOCK(m);
+    return go;
+}
+
+bool SolveCancelled(const SolverContext *ctx) {
+    SolverMonitor *m = ctx->monitor;
+    if (!m) return false;
+    MONITOR_LOCK(m);
+    bool cancel = m->cancel;
+    MONITOR_UNLOCK(m);
+    return cancel;
+}
+
+const char* SolverPhaseName(SolverPhase phase) {
+    switch (phase) {
+        case PHASE_ACCESSIBILITY: return "accessibility";
+        case PHASE_DISTANCES: return "distances";
+        case PHASE_SEARCH: return "search";
+        case PHASE_TOUR: return "tour";
+        case PHASE_PATH: return "path";
+        case PHASE_DONE: return "done";
+        default: return "idle";
+    }
+}
+
+static void RunSolveTask(void *arg) {
+    SolveTask *task = (SolveTask*)arg;
+    SolverContext *ctx = task->ctx;
+    CheckAccessibility(ctx);
+    task->solved = !SolveCancelled(ctx) && SolveTSP(ctx);
+    ProgressPhase(ctx, PHASE_DONE, 0);
+
+    MONITOR_LOCK(&task->monitor);
+    task->monitor.finished = true;
+    MONITOR_UNLOCK(&task->monitor);
+}
+
+SolveTask* StartSolveTask(SolverContext *ctx) {
+    SolveTask *task = (SolveTask*)calloc(1, sizeof(SolveTask));
+    if (!task) return NULL;
+    task->ctx = ctx;
+    task->monitor.progress.bound = -1;
+    ctx->monitor = &task->monitor;
+#ifdef SOLVER_NO_THREADS
+    RunSolveTask(task);
+#else
+    initMutex(&task->monitor.lock);
+    task->threaded = startThread(&task->thread, RunSolveTask, task);
+    // no thread to spare, solve right here
+    if (!task->threaded) RunSolveTask(task);
+#endif
+    return task;
+}
+
+bool PollSolveTask(SolveTask *task, SolverProgress *progress) {
+    MONITOR_LOCK(&task->monitor);
+    if (progress) *progress = task->monitor.progress;
+    bool finished = task->monitor.finished;
+    MONITOR_UNLOCK(&task->monitor);
+    return finished;
+}
+
+void CancelSolveTask(SolveTask *task) {
+    MONITOR_LOCK(&task->monitor);
+    task->monitor.cancel = true;
+    MONITOR_UNLOCK(&task->monitor);
+}
+
+bool FinishSolveTask(SolveTask *task, bool *cancelled) {
+#ifndef SOLVER_NO_THREADS
+    if (task->threaded) joinThread(task->thread);
+    destroyMutex(&task->monitor.lock);
+#endif
+    bool solved = task->solved;
+    if (cancelled) *cancelled = task->monitor.cancel && !solved;
+    task->ctx->monitor = NULL;
+    free(task);
+    return solved;
+}
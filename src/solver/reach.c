@@ -0,0 +1,445 @@
+#include "solver_internal.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bitset reachability
+//
+// Poses are held as one bitset per (mode, row), bit c standing for the pose anchored at
+// column c. Every move is a fixed (mode, dx, dy) offset, so applying it to a whole row is
+// a word shift by dx into row r + dy, ANDed with that row's free poses. The search keeps
+// a worklist of (mode, row) pairs with the bits they gained since they were last
+// expanded, plus the word span those bits sit in, so each expansion only touches the
+// words that changed and a pose is expanded exactly once, as in a queue BFS. Every mode
+// also slides one column either way without turning, so before a row's new bits are
+// passed on they are grown over the free runs they sit in with an occluded fill, instead
+// of crawling along the row a column per expansion.
+
+// word w of row shifted towards higher columns by s (|s| < 64), zero filled
+static inline uint64_t ShiftedWord(const uint64_t *row, int words, int w, int s) {
+    if (s == 0) return row[w];
+    if (s > 0) return (row[w] << s) | (w > 0 ? row[w - 1] >> (64 - s) : 0);
+    return (row[w] >> -s) | (w + 1 < words ? row[w + 1] << (64 + s) : 0);
+}
+
+// free[(m * rows + r) * words + w]: the poses that pass CheckCarCollision, built from
+// per-row free-cell bitsets by ANDing the car body offsets
+static void BuildFreeRows(const SolverContext *ctx, int words, uint64_t *cellRows, uint64_t *freeRows) {
+    int rows = ctx->rows, cols = ctx->cols;
+    memset(cellRows, 0, (size_t)rows * words * sizeof(uint64_t));
+    for (int r = 0; r < rows; r++) {
+        const uint8_t *line = &MAZE_AT(ctx, r, 0);
+        uint64_t *cells = cellRows + (size_t)r * words;
+        for (int c = 0; c < cols; c++) cells[c >> 6] |= (uint64_t)(line[c] != 0) << (c & 63);
+    }
+    int body[6][2];
+    for (int m = 0; m < 4; m++) {
+        GetCarBody(m, body);
+        for (int r = 0; r < rows; r++) {
+            uint64_t *out = freeRows + ((size_t)m * rows + r) * words;
+            for (int w = 0; w < words; w++) out[w] = ~(uint64_t)0;
+            for (int b = 0; b < 6; b++) {
+                int cy = r + body[b][1];
+                if ((unsigned)cy >= (unsigned)rows) { memset(out, 0, words * sizeof(uint64_t)); break; }
+                const uint64_t *cells = cellRows + (size_t)cy * words;
+                for (int w = 0; w < words; w++) out[w] &= ShiftedWord(cells, words, w, -body[b][0]);
+            }
+        }
+    }
+}
+
+// seeds grown towards higher columns through the set bits of open, one word
+static inline uint64_t FillUp(uint64_t seed, uint64_t open) {
+    seed |= open & (seed << 1);  open &= open << 1;
+    seed |= open & (seed << 2);  open &= open << 2;
+    seed |= open & (seed << 4);  open &= open << 4;
+    seed |= open & (seed << 8);  open &= open << 8;
+    seed |= open & (seed << 16); open &= open << 16;
+    return seed | (open & (seed << 32));
+}
+
+static inline uint64_t FillDown(uint64_t seed, uint64_t open) {
+    seed |= open & (seed >> 1);  open &= open >> 1;
+    seed |= open & (seed >> 2);  open &= open >> 2;
+    seed |= open & (seed >> 4);  open &= open >> 4;
+    seed |= open & (seed >> 8);  open &= open >> 8;
+    seed |= open & (seed >> 16); open &= open >> 16;
+    return seed | (open & (seed >> 32));
+}
+
+// grows the bits of delta in words [*lo, *hi] over the free run they sit in, adds what
+// is new to reach and delta and widens the span to match
+static void FillRow(uint64_t *delta, uint64_t *reach, const uint64_t *open, int words, bool up, bool down, int *lo, int *hi) {
+    if (up) {
+        uint64_t carry = 0;
+        for (int w = *lo; w < words && (w <= *hi || carry); w++) {
+            uint64_t grown = FillUp(delta[w] | (carry & open[w]), open[w]);
+            carry = grown >> 63;
+            uint64_t gained = grown & ~reach[w];
+            if (!gained) continue;
+            reach[w] |= gained;
+            delta[w] |= gained;
+            if (w > *hi) *hi = w;
+        }
+    }
+    if (down) {
+        uint64_t carry = 0;
+        for (int w = *hi; w >= 0 && (w >= *lo || carry); w--) {
+            uint64_t grown = FillDown(delta[w] | ((carry << 63) & open[w]), open[w]);
+            carry = grown & 1;
+            uint64_t gained = grown & ~reach[w];
+            if (!gained) continue;
+            reach[w] |= gained;
+            delta[w] |= gained;
+            if (w < *lo) *lo = w;
+        }
+    }
+}
+
+bool ReachablePoseBits(const SolverContext *ctx, State start, uint64_t *reach) {
+    int rows = ctx->rows, cols = ctx->cols;
+    int words = (cols + 63) / 64;
+    size_t rowCount = (size_t)rows * 4;
+    size_t bitWords = rowCount * words;
+    memset(reach, 0, bitWords * sizeof(uint64_t));
+
+    uint64_t *freeRows = (uint64_t*)malloc(bitWords * sizeof(uint64_t));
+    uint64_t *cellRows = (uint64_t*)malloc((size_t)rows * words * sizeof(uint64_t));
+    uint64_t *pending = (uint64_t*)calloc(bitWords, sizeof(uint64_t));   // bits not expanded yet
+    uint64_t *delta = (uint64_t*)calloc(words, sizeof(uint64_t));
+    int *spanLo = (int*)malloc(rowCount * sizeof(int));                 // pending words, lo > hi when none
+    int *spanHi = (int*)malloc(rowCount * sizeof(int));
+    size_t *work = (size_t*)malloc(rowCount * sizeof(size_t));           // ring of rows with pending bits
+    if (!freeRows || !cellRows || !pending || !delta || !spanLo || !spanHi || !work) {
+        free(freeRows); free(cellRows); free(pending); free(delta); free(spanLo); free(spanHi); free(work);
+        return false;
+    }
+    BuildFreeRows(ctx, words, cellRows, freeRows);
+    free(cellRows);
+    for (size_t i = 0; i < rowCount; i++) { spanLo[i] = INT_MAX; spanHi[i] = -1; }
+
+    // slides[m][0/1]: mode m has a move one column left/right in the same mode and row
+    bool slides[4][2] = {{false}};
+    for (int m = 0; m < 4; m++) {
+        for (int i = 0; i < 8; i++) {
+            const int *mv = ctx->moves[m][i];
+            if (mv[0] == m && mv[2] == 0 && (mv[1] == -1 || mv[1] == 1)) slides[m][mv[1] > 0] = true;
+        }
+    }
+
+    size_t head = 0, queued = 0, expanded = 0;
+    bool done = true;
+    if (IsPoseFree(ctx, start.x, start.y, start.mode)) {
+        size_t key = (size_t)start.mode * rows + start.y;
+        uint64_t bit = (uint64_t)1 << (start.x & 63);
+        reach[key * words + (start.x >> 6)] = bit;
+        pending[key * words + (start.x >> 6)] = bit;
+        spanLo[key] = spanHi[key] = start.x >> 6;
+        work[queued++] = key;
+    }
+    while (queued > 0) {
+        if ((++expanded & (PROGRESS_INTERVAL - 1)) == 0 && !ProgressTick(ctx, expanded, -1)) { done = false; break; }
+        size_t key = work[head];
+        head = (head + 1) % rowCount;
+        queued--;
+        int m = (int)(key / rows), r = (int)(key % rows);
+        int lo = spanLo[key], hi = spanHi[key];
+        uint64_t *own = pending + key * words;
+        for (int w = lo; w <= hi; w++) { delta[w] = own[w]; own[w] = 0; }
+        spanLo[key] = INT_MAX;
+        spanHi[key] = -1;
+        FillRow(delta, reach + key * words, freeRows + key * words, words, slides[m][1], slides[m][0], &lo, &hi);
+
+        for (int i = 0; i < 8; i++) {
+            int nm = ctx->moves[m][i][0];
+            int dx = ctx->moves[m][i][1];
+            int ty = r + ctx->moves[m][i][2];
+            if ((unsigned)ty >= (unsigned)rows) continue;
+            if (nm == m && ty == r && (dx == -1 || dx == 1) && slides[m][dx > 0]) continue;   // done by FillRow
+            size_t tkey = (size_t)nm * rows + ty;
+            const uint64_t *tfree = freeRows + tkey * words;
+            uint64_t *treach = reach + tkey * words;
+            uint64_t *tpending = pending + tkey * words;
+            int wlo = dx < 0 && lo > 0 ? lo - 1 : lo;
+            int whi = dx > 0 && hi + 1 < words ? hi + 1 : hi;
+            for (int w = wlo; w <= whi; w++) {
+                uint64_t gained = ShiftedWord(delta, words, w, dx) & tfree[w] & ~treach[w];
+                if (!gained) continue;
+                treach[w] |= gained;
+                tpending[w] |= gained;
+                if (spanHi[tkey] < 0) work[(head + queued++) % rowCount] = tkey;
+                if (w < spanLo[tkey]) spanLo[tkey] = w;
+                if (w > spanHi[tkey]) spanHi[tkey] = w;
+            }
+        }
+        for (int w = lo; w <= hi; w++) delta[w] = 0;
+    }
+
+    free(freeRows); free(pending); free(delta); free(spanLo); free(spanHi); free(work);
+    return done;
+}
+
+// 16 bits moved to every fourth bit of a word
+static inline uint64_t SpreadBits4(uint64_t x) {
+    x &= 0xFFFF;
+    x = (x | (x << 24)) & 0x000000FF000000FFULL;
+    x = (x | (x << 12)) & 0x000F000F000F000FULL;
+    x = (x | (x << 6)) & 0x0303030303030303ULL;
+    return (x | (x << 3)) & 0x1111111111111111ULL;
+}
+
+void ReachToPoseBits(const SolverContext *ctx, const uint64_t *reach, uint64_t *bits) {
+    int rows = ctx->rows, cols = ctx->cols;
+    int words = (cols + 63) / 64;
+    size_t poseWords = ((size_t)rows * cols * 4 + 63) / 64;
+    memset(bits, 0, poseWords * sizeof(uint64_t));
+    // 16 columns of the four mode rows make one word of IDX_POS bits, which may straddle two
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c += 16) {
+            uint64_t chunk = 0;
+            for (int m = 0; m < 4; m++) {
+                uint64_t w = reach[((size_t)m * rows + r) * words + (c >> 6)];
+                chunk |= SpreadBits4(w >> (c & 63)) << m;
+            }
+            if (!chunk) continue;
+            size_t at = IDX_POS(r, c, 0, cols);
+            bits[at >> 6] |= chunk << (at & 63);
+            if ((at & 63) && (at >> 6) + 1 < poseWords) bits[(at >> 6) + 1] |= chunk >> (64 - (at & 63));
+        }
+    }
+}
+
+// Incremental reachability
+//
+// UpdateReachable keeps visited and the pose index in step with SetMazeCell. When every
+// move can be undone by another, the reachable poses are the start's connected piece of
+// an undirected graph, and an edit only changes it around the flipped poses. A freed
+// pose joins when a reachable pose is next to it, and a BFS from there over the free
+// poses nobody reached collects what it opened up. A blocked pose that was reachable
+// may split the piece: a search from each reachable neighbour it leaves behind runs in
+// turn, one pose at a time, over the poses still reachable. Searches that meet merge,
+// and once only the search holding the start can still grow, the others ran dry on
+// the poses that were cut off. In open floor they meet after a few poses, so only an
+// edit that really cuts off or opens up an area pays for its size.
+
+typedef struct {
+    size_t *idx;
+    size_t count, cap;
+} PoseList;
+
+static bool AppendPose(PoseList *list, size_t idx) {
+    if (list->count == list->cap) {
+        size_t cap = list->cap ? list->cap * 2 : 64;
+        size_t *grown = (size_t*)realloc(list->idx, cap * sizeof(size_t));
+        if (!grown) return false;
+        list->idx = grown;
+        list->cap = cap;
+    }
+    list->idx[list->count++] = idx;
+    return true;
+}
+
+// search of each pose the cut searches reached, open addressing on IDX_POS
+typedef struct {
+    size_t *key;        // SIZE_MAX in empty slots
+    int *label;
+    size_t cap, count;
+} PoseLabels;
+
+static bool InitLabels(PoseLabels *labels, size_t cap) {
+    labels->key = (size_t*)malloc(cap * sizeof(size_t));
+    labels->label = (int*)malloc(cap * sizeof(int));
+    labels->cap = cap;
+    labels->count = 0;
+    if (!labels->key || !labels->label) { free(labels->key); free(labels->label); return false; }
+    memset(labels->key, 0xFF, cap * sizeof(size_t));
+    return true;
+}
+
+static size_t LabelSlot(const PoseLabels *labels, size_t idx) {
+    size_t mask = labels->cap - 1;
+    size_t h = (size_t)(((uint64_t)idx * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while (labels->key[h] != SIZE_MAX && labels->key[h] != idx) h = (h + 1) & mask;
+    return h;
+}
+
+// search that reached idx, -1 when none did
+static int GetLabel(const PoseLabels *labels, size_t idx) {
+    size_t h = LabelSlot(labels, idx);
+    return labels->key[h] == SIZE_MAX ? -1 : labels->label[h];
+}
+
+static bool SetLabel(PoseLabels *labels, size_t idx, int label) {
+    if (2 * (labels->count + 1) > labels->cap) {
+        PoseLabels grown;
+        if (!InitLabels(&grown, labels->cap * 2)) return false;
+        for (size_t i = 0; i < labels->cap; i++) {
+            if (labels->key[i] == SIZE_MAX) continue;
+            size_t h = LabelSlot(&grown, labels->key[i]);
+            grown.key[h] = labels->key[i];
+            grown.label[h] = labels->label[i];
+        }
+        grown.count = labels->count;
+        free(labels->key);
+        free(labels->label);
+        *labels = grown;
+    }
+    size_t h = LabelSlot(labels, idx);
+    labels->key[h] = idx;
+    labels->label[h] = label;
+    labels->count++;
+    return true;
+}
+
+// true when every move has one that leads straight back
+static bool MovesReversible(const SolverContext *ctx) {
+    for (int m = 0; m < 4; m++) {
+        for (int i = 0; i < 8; i++) {
+            const int *mv = ctx->moves[m][i];
+            bool back = false;
+            for (int j = 0; j < 8 && !back; j++) {
+                const int *rv = ctx->moves[mv[0]][j];
+                back = rv[0] == m && rv[1] == -mv[1] && rv[2] == -mv[2];
+            }
+            if (!back) return false;
+        }
+    }
+    return true;
+}
+
+// the pose move i takes IDX_POS pose idx to, SIZE_MAX when that pose is not free
+static size_t MovedPose(const SolverContext *ctx, size_t idx, int i) {
+    int cols = ctx->cols;
+    int x = (int)((idx / 4) % cols), y = (int)((idx / 4) / cols);
+    const int *mv = ctx->moves[idx % 4][i];
+    int nx = x + mv[1], ny = y + mv[2];
+    return IsPoseFree(ctx, nx, ny, mv[0]) ? IDX_POS(ny, nx, mv[0], cols) : SIZE_MAX;
+}
+
+static inline bool PoseBitFree(const SolverContext *ctx, size_t idx) {
+    return (ctx->poseFree[idx >> 6] >> (idx & 63)) & 1;
+}
+
+typedef struct {
+    PoseList poses;     // reached poses in BFS order, the ones from head on are not expanded yet
+    size_t head;
+} CutSearch;
+
+static int RootSearch(int *parent, int s) {
+    while (parent[s] != s) s = parent[s] = parent[parent[s]];
+    return s;
+}
+
+// blocked poses leave the reachable set and take the poses they cut off with them
+static bool CutBlockedPoses(SolverContext *ctx, const size_t *flipped, int flipCount, PoseList *toggled) {
+    bool *visited = ctx->visited;
+    size_t blocked = toggled->count;
+    for (int f = 0; f < flipCount; f++) {
+        if (!visited[flipped[f]] || PoseBitFree(ctx, flipped[f])) continue;
+        visited[flipped[f]] = false;
+        if (!AppendPose(toggled, flipped[f])) return false;
+    }
+    int seedCap = (int)(toggled->count - blocked) * 8;
+    if (seedCap == 0) return true;      // every blocked pose was out of reach already
+
+    // parent merges searches that met, open counts the searches of a root that can still grow
+    CutSearch *search = (CutSearch*)calloc(seedCap, sizeof(CutSearch));
+    int *parent = (int*)malloc(seedCap * sizeof(int));
+    int *open = (int*)malloc(seedCap * sizeof(int));
+    PoseLabels labels = {0};
+    bool ok = search && parent && open && InitLabels(&labels, 1024);
+    size_t startIdx = IDX_POS(ctx->start_state.y, ctx->start_state.x, ctx->start_state.mode, ctx->cols);
+    int count = 0, growing = 0, startSearch = -1;
+    for (size_t b = blocked; b < toggled->count && ok; b++) {
+        for (int i = 0; i < 8 && ok; i++) {
+            size_t q = MovedPose(ctx, toggled->idx[b], i);
+            if (q == SIZE_MAX || !visited[q] || GetLabel(&labels, q) >= 0) continue;
+            parent[count] = count;
+            open[count] = 1;
+            growing++;
+            if (q == startIdx) startSearch = count;
+            ok = SetLabel(&labels, q, count) && AppendPose(&search[count++].poses, q);
+        }
+    }
+
+    // the piece holding the start stays, which is the only growing one when the start
+    // was not reached yet: the start is linked to some seed
+    while (ok && growing > 0 && !(growing == 1 && (startSearch < 0 || open[RootSearch(parent, startSearch)] > 0))) {
+        for (int s = 0; s < count && ok; s++) {
+            CutSearch *cs = &search[s];
+            if (cs->head == cs->poses.count) continue;
+            size_t u = cs->poses.idx[cs->head++];
+            for (int i = 0; i < 8 && ok; i++) {
+                size_t q = MovedPose(ctx, u, i);
+                if (q == SIZE_MAX || !visited[q]) continue;
+                int other = GetLabel(&labels, q);
+                if (other < 0) {
+                    if (q == startIdx) startSearch = s;
+                    ok = SetLabel(&labels, q, s) && AppendPose(&cs->poses, q);
+                    continue;
+                }
+                int a = RootSearch(parent, s), b = RootSearch(parent, other);
+                if (a == b) continue;
+                if (open[a] > 0 && open[b] > 0) growing--;
+                parent[b] = a;
+                open[a] += open[b];
+            }
+            if (cs->head == cs->poses.count && --open[RootSearch(parent, s)] == 0) growing--;
+        }
+    }
+
+    int startRoot = startSearch >= 0 ? RootSearch(parent, startSearch) : -1;
+    for (int s = 0; s < count && ok; s++) {
+        int root = RootSearch(parent, s);
+        if (root == startRoot || open[root] > 0) continue;
+        for (size_t i = 0; i < search[s].poses.count && ok; i++) {
+            visited[search[s].poses.idx[i]] = false;
+            ok = AppendPose(toggled, search[s].poses.idx[i]);
+        }
+    }
+
+    if (search) for (int s = 0; s < count; s++) free(search[s].poses.idx);
+    free(search); free(parent); free(open);
+    free(labels.key); free(labels.label);
+    return ok;
+}
+
+// freed poses next to a reachable one join it, with every free pose they lead to
+static bool JoinFreedPoses(SolverContext *ctx, const size_t *flipped, int flipCount, PoseList *toggled) {
+    bool *visited = ctx->visited;
+    size_t joined = toggled->count;
+    for (int f = 0; f < flipCount; f++) {
+        size_t p = flipped[f];
+        if (visited[p] || !PoseBitFree(ctx, p)) continue;
+        bool touches = false;
+        for (int i = 0; i < 8 && !touches; i++) {
+            size_t q = MovedPose(ctx, p, i);
+            touches = q != SIZE_MAX && visited[q];
+        }
+        if (!touches) continue;
+        visited[p] = true;
+        if (!AppendPose(toggled, p)) return false;
+    }
+    // the poses toggled from joined on double as the BFS queue
+    for (size_t h = joined; h < toggled->count; h++) {
+        for (int i = 0; i < 8; i++) {
+            size_t q = MovedPose(ctx, toggled->idx[h], i);
+            if (q == SIZE_MAX || visited[q]) continue;
+            visited[q] = true;
+            if (!AppendPose(toggled, q)) return false;
+        }
+    }
+    return true;
+}
+
+bool UpdateReachable(SolverContext *ctx, const size_t *flipped, int flipCount) {
+    if (!ctx->visited || !MovesReversible(ctx)) return false;
+    PoseList toggled = {0};
+    bool ok = CutBlockedPoses(ctx, flipped, flipCount, &toggled) && JoinFreedPoses(ctx, flipped, flipCount, &toggled);
+    if (ok) {
+        TogglePoseIndex(ctx, toggled.idx, toggled.count);
+        MarkReachableObjectives(ctx);
+    }
+    free(toggled.idx);
+    return ok;
+}
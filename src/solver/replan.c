@@ -0,0 +1,230 @@
+#include "solver_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Incremental re-planning
+//
+// StartReplanner grows a complete reverse tree with distances for every objective, in
+// the order of ctx->objectives. SetMazeCell then keeps the trees in step with the maze:
+// a new objective grows its tree right away, a removed one drops it, and every pose
+// whose legality flips is queued. Replan repairs the queued poses in all trees (see
+// RepairLegTrees), reads the cost matrix off the tree distances and walks the tour legs
+// down the trees. Each edit also patches the reachable poses and the pose index around
+// the flipped poses (see UpdateReachable), so a re-plan strikes and keeps the same
+// objectives a cold solve of the edited maze would without searching the whole maze.
+
+struct Replanner {
+    LegCache cache;         // tree t belongs to ctx->objectives[t]
+    size_t *changed;        // poses whose legality flipped since the last plan
+    int changedCount, changedCap;
+    bool staleReach;        // a full reachability search failed, Replan runs it again
+};
+
+static void QueueChangedPose(Replanner *rp, size_t idx) {
+    if (rp->changedCount == rp->changedCap) {
+        rp->changedCap = rp->changedCap ? rp->changedCap * 2 : 64;
+        rp->changed = (size_t*)realloc(rp->changed, rp->changedCap * sizeof(size_t));
+    }
+    rp->changed[rp->changedCount++] = idx;
+}
+
+// re-tests the poses whose body covers cell (x, y) and follows the reachable poses
+static void UpdatePoseTable(SolverContext *ctx, int x, int y) {
+    size_t flipped[24];
+    int flipCount = 0;
+    int body[6][2];
+    for (int m = 0; m < 4; m++) {
+        GetCarBody(m, body);
+        for (int b = 0; b < 6; b++) {
+            int px = x - body[b][0], py = y - body[b][1];
+            if ((unsigned)px >= (unsigned)ctx->cols || (unsigned)py >= (unsigned)ctx->rows) continue;
+            bool isFree = CheckCarCollision(ctx, px, py, m);
+            if (isFree == IsPoseFree(ctx, px, py, m)) continue;
+            size_t idx = IDX_POS(py, px, m, ctx->cols);
+            ctx->poseFree[idx >> 6] ^= (uint64_t)1 << (idx & 63);
+            flipped[flipCount++] = idx;
+            if (ctx->replanner) QueueChangedPose(ctx->replanner, idx);
+        }
+    }
+    if (flipCount == 0 || !ctx->visited || UpdateReachable(ctx, flipped, flipCount)) return;
+    // a move table that cannot be undone, or no memory: search the whole maze again
+    if (!MarkReachable(ctx) && ctx->replanner) ctx->replanner->staleReach = true;
+}
+
+// strikes the objectives the car cannot stand on from the maze and the list, as
+// CheckAccessibility does, and drops their trees
+static void DropUnreachableObjectives(SolverContext *ctx) {
+    for (int i = ctx->objCount - 1; i >= 0; i--) {
+        Objective *o = &ctx->objectives[i];
+        if (o->reachable) continue;
+        MAZE_AT(ctx, o->y, o->x) = 1;
+        *o = ctx->objectives[--ctx->objCount];
+        if (ctx->replanner) RemoveLegTree(&ctx->replanner->cache, i);
+    }
+}
+
+// the maze order CollectObjectives lists objectives in, so the tour is built as cold
+static int CompareMazeOrder(const void *a, const void *b) {
+    const ActiveTarget *ta = (const ActiveTarget*)a, *tb = (const ActiveTarget*)b;
+    if (ta->y != tb->y) return ta->y < tb->y ? -1 : 1;
+    return (ta->x > tb->x) - (ta->x < tb->x);
+}
+
+bool SetMazeCell(SolverContext *ctx, int x, int y, int value) {
+    if ((unsigned)x >= (unsigned)ctx->cols || (unsigned)y >= (unsigned)ctx->rows) return false;
+    if (value != 0 && value != 1 && value != 3) return false;
+    int old = MAZE_AT(ctx, y, x);
+    if (old == 2) return false;
+    if (old == value) return true;
+
+    MAZE_AT(ctx, y, x) = (uint8_t)value;
+    if ((old == 0) != (value == 0)) UpdatePoseTable(ctx, x, y);
+    if (!ctx->objectives) return true;
+
+    // the last objective moves into the gap, as the last tree does in RemoveLegTree
+    if (old == 3) {
+        for (int i = 0; i < ctx->objCount; i++) {
+            if (ctx->objectives[i].x != x || ctx->objectives[i].y != y) continue;
+            if (ctx->objectives[i].reachable) ctx->reachableCount--;
+            ctx->objectives[i] = ctx->objectives[--ctx->objCount];
+            if (ctx->replanner) RemoveLegTree(&ctx->replanner->cache, i);
+            break;
+        }
+    }
+    if (value == 3) {
+        Objective *objectives = (Objective*)realloc(ctx->objectives, (ctx->objCount + 1) * sizeof(Objective));
+        if (!objectives) return false;
+        ctx->objectives = objectives;
+        Objective *o = &ctx->objectives[ctx->objCount++];
+        *o = (Objective){x, y, false};
+        for (int m = 0; m < 4 && ctx->visited && !o->reachable; m++) o->reachable = ctx->visited[IDX_POS(y, x, m, ctx->cols)];
+        if (o->reachable) ctx->reachableCount++;
+        if (ctx->replanner && AddLegTree(ctx, &ctx->replanner->cache, x, y) < 0) {
+            // no room for the tree, the replanner cannot follow this maze any more
+            SOLVER_LOG(ctx, "Replanner stopped: no memory for the tree of (%d, %d).\n", x, y);
+            StopReplanner(ctx);
+            return false;
+        }
+    }
+    return true;
+}
+
+void StopReplanner(SolverContext *ctx) {
+    Replanner *rp = ctx->replanner;
+    if (!rp) return;
+    FreeLegCache(&rp->cache);
+    free(rp->changed);
+    free(rp);
+    ctx->replanner = NULL;
+}
+
+bool StartReplanner(SolverContext *ctx) {
+    StopReplanner(ctx);
+    CollectObjectives(ctx);
+    if (!MarkReachable(ctx)) return false;
+    DropUnreachableObjectives(ctx);
+    if (LegCacheBytes(ctx, ctx->objCount, 0, true) > SolverMemoryBudget(ctx)) {
+        SOLVER_LOG(ctx, "Replanner trees exceed the %zu MB budget.\n", SolverMemoryBudget(ctx) >> 20);
+        return false;
+    }
+    Replanner *rp = (Replanner*)calloc(1, sizeof(Replanner));
+    if (!rp) return false;
+    if (!InitLegCache(ctx, &rp->cache, ctx->objCount, true)) { free(rp); return false; }
+
+    // BuildLegCache grows the trees on the pool, its matrix is rebuilt by Replan anyway
+    int nodeCount = ctx->objCount + 1;
+    ActiveTarget *nodes = (ActiveTarget*)malloc(nodeCount * sizeof(ActiveTarget));
+    State *anchors = (State*)malloc(nodeCount * sizeof(State));
+    int *costMat = (int*)malloc((size_t)nodeCount * nodeCount * sizeof(int));
+    nodes[0] = (ActiveTarget){ctx->start_state.x, ctx->start_state.y, -1};
+    anchors[0] = ctx->start_state;
+    for (int i = 1; i < nodeCount; i++) {
+        const Objective *o = &ctx->objectives[i - 1];
+        nodes[i] = (ActiveTarget){o->x, o->y, i - 1};
+        anchors[i] = (State){o->x, o->y, GetSimpleMode(ctx, o->x, o->y)};
+    }
+    double statsStart = StatsStart(ctx);
+    BuildLegCache(ctx, &rp->cache, nodes, nodeCount, anchors, costMat, nodeCount);
+    StatsStop(ctx, STATS_MATRIX, statsStart, 0);
+    free(nodes);
+    free(anchors);
+    free(costMat);
+
+    ctx->replanner = rp;
+    return Replan(ctx);
+}
+
+bool Replan(SolverContext *ctx) {
+    Replanner *rp = ctx->replanner;
+    if (!rp) return false;
+    double solveStart = SolverGetTime();
+    double statsStart = StatsStart(ctx);
+    LegCache *cache = &rp->cache;
+    State start = ctx->start_state;
+
+    ActiveTarget *allNodes = (ActiveTarget*)malloc((ctx->objCount + 1) * sizeof(ActiveTarget));
+    for (int i = 0; i < ctx->objCount; i++) allNodes[i] = (ActiveTarget){ctx->objectives[i].x, ctx->objectives[i].y, i};
+    RepairLegTrees(ctx, cache, allNodes, rp->changed, rp->changedCount);
+    rp->changedCount = 0;
+
+    PathTraceFree(&ctx->tspPath);
+    ctx->totalFuelCost = 0;
+    bool marked = !rp->staleReach || MarkReachable(ctx);
+    rp->staleReach = !marked;
+    if (marked) DropUnreachableObjectives(ctx);
+    if (!marked || ctx->reachableCount == 0) {
+        free(allNodes);
+        StatsStop(ctx, STATS_REPLAN, statsStart, 0);
+        return false;
+    }
+
+    // allNodes[0] is the start, the reachable objectives follow with their tree index
+    int numRealNodes = CollectActiveTargets(ctx, allNodes + 1) + 1;
+    int totalNodes = numRealNodes + 1;
+    allNodes[0] = (ActiveTarget){start.x, start.y, -1};
+    qsort(allNodes + 1, numRealNodes - 1, sizeof(ActiveTarget), CompareMazeOrder);
+    int *costMat = (int*)calloc((size_t)totalNodes * totalNodes, sizeof(int));
+    for (int i = 0; i < numRealNodes; i++) {
+        State anchor = i == 0 ? start : (State){allNodes[i].x, allNodes[i].y, GetSimpleMode(ctx, allNodes[i].x, allNodes[i].y)};
+        for (int j = i + 1; j < numRealNodes; j++) {
+            int c = LegTreeDist(ctx, cache, allNodes[j].originalIdx, anchor);
+            if (c < 0) c = LEG_COST_NONE;
+            costMat[i * totalNodes + j] = c;
+            costMat[j * totalNodes + i] = c;
+        }
+    }
+
+    int *visitOrder = (int*)malloc(totalNodes * sizeof(int));
+    int orderCount = ChristofidesOrder(costMat, numRealNodes, visitOrder);
+    if (ctx->approxTimeBudget > 0) {
+        ImproveTour(ctx, costMat, totalNodes, visitOrder, orderCount, solveStart + ctx->approxTimeBudget, NULL, NULL);
+    }
+
+    // every reachable pose is in every complete tree, so each leg is a walk
+    bool planned = PathTraceStart(&ctx->tspPath, (PathStep){start.x, start.y, start.mode});
+    for (int i = 1; i < orderCount && planned; i++) {
+        const ActiveTarget *target = &allNodes[visitOrder[i]];
+        PathStep last = ctx->tspPath.last;
+        int legCost = WalkLeg(ctx, cache, target->originalIdx, (State){last.x, last.y, last.m}, &ctx->tspPath);
+        if (legCost == -1) {
+            SOLVER_LOG(ctx, "Replan: FAILURE, no leg from (%d, %d) to (%d, %d).\n", last.x, last.y, target->x, target->y);
+            planned = false;
+        } else {
+            ctx->totalFuelCost += legCost;
+        }
+    }
+    StatsStop(ctx, STATS_REPLAN, statsStart, (size_t)totalNodes * totalNodes * sizeof(int) + PathTraceBytes(&ctx->tspPath));
+    if (planned) {
+        ctx->engineUsed = TSP_APPROX;
+        SOLVER_LOG(ctx, "Replan: %d of %d objectives, cost %d, %.3f ms\n", ctx->reachableCount, ctx->objCount,
+                   ctx->totalFuelCost, (SolverGetTime() - solveStart) * 1e3);
+    } else {
+        PathTraceFree(&ctx->tspPath);
+        ctx->totalFuelCost = 0;
+    }
+
+    free(costMat);
+    free(visitOrder);
+    free(allNodes);
+    return planned;
+}
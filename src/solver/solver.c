@@ -0,0 +1,1411 @@
+#include "solver_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+
+// [mode][dir][0:new_mode, 1:dx, 2:dy, 3:fuel]
+const int Mode_Movement_Fuel[4][8][4] = {
+    {{0,0,1,1},{0,0,-1,1},{0,1,0,3},{0,-1,0,3},{1,2,0,3},{1,1,1,3},{3,0,2,3},{3,-1,1,3}},
+    {{1,1,0,1},{1,-1,0,1},{1,0,-1,3},{1,0,1,3},{2,0,2,3},{2,-1,1,3},{0,-2,0,3},{0,-1,-1,3}},
+    {{2,0,-1,1},{2,0,1,1},{2,-1,0,3},{2,1,0,3},{3,-2,0,3},{3,-1,-1,3},{1,0,-2,3},{1,1,-1,3}},
+    {{3,-1,0,1},{3,1,0,1},{3,0,1,3},{3,0,-1,3},{0,0,-2,3},{0,1,-1,3},{2,2,0,3},{2,1,1,3}}
+};
+
+// largest fuel cost in the move table, picks the queue engine
+static int MaxMoveFuel(const SolverContext *ctx) {
+    int maxFuel = 0;
+    for (int m = 0; m < 4; m++)
+        for (int i = 0; i < 8; i++)
+            if (ctx->moves[m][i][3] > maxFuel) maxFuel = ctx->moves[m][i][3];
+    return maxFuel;
+}
+PQueue* createSearchQueue(const SolverContext *ctx) {
+    return createPQueue(ctx->queueEngine, MaxMoveFuel(ctx));
+}
+
+ThreadPool* GetSolverPool(SolverContext *ctx) {
+    if (!ctx->pool) ctx->pool = createThreadPool(ctx->workerCount);
+    return ctx->pool;
+}
+
+// lifetime
+void SolverInit(SolverContext *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->moves = Mode_Movement_Fuel;
+    ctx->queueEngine = PQ_AUTO;
+    ctx->stateStore = STORE_AUTO;
+    ctx->exactHeuristic = true;
+    ctx->tspEngine = TSP_AUTO;
+}
+
+void SolverFree(SolverContext *ctx) {
+    StopReplanner(ctx);
+    FreePoseIndex(&ctx->poseIndex);
+    PathTraceFree(&ctx->tspPath);
+    free(ctx->poseFree);
+    free(ctx->objectives);
+    free(ctx->visited);
+    freeThreadPool(ctx->pool);
+    free(ctx->maze);
+    ctx->maze = NULL;
+    ctx->poseFree = NULL;
+    ctx->objectives = NULL;
+    ctx->visited = NULL;
+    ctx->pool = NULL;
+    ctx->rows = ctx->cols = 0;
+    ctx->objCount = ctx->reachableCount = 0;
+}
+
+double SolverGetTime(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// [mode][cell][0:dx, 1:dy] relative to the pose anchor
+static const int carBody[4][6][2] = {
+    {{0,0},{1,0},{0,1},{1,1},{0,2},{1,2}},
+    {{0,0},{-1,0},{-2,0},{0,1},{-1,1},{-2,1}},
+    {{0,0},{-1,0},{0,-1},{-1,-1},{0,-2},{-1,-2}},
+    {{0,0},{1,0},{2,0},{0,-1},{1,-1},{2,-1}}
+};
+
+void GetCarBody(int mode, int body[6][2]) {
+    memcpy(body, carBody[mode], sizeof(carBody[mode]));
+}
+
+int CheckCarCollision(const SolverContext *ctx, int x, int y, int mode) {
+    int body[6][2];
+    GetCarBody(mode, body);
+    for (int i = 0; i < 6; i++) {
+        int cx = x + body[i][0];
+        int cy = y + body[i][1];
+        if (cx < 0 || cx >= ctx->cols || cy < 0 || cy >= ctx->rows) return 0;
+        if (MAZE_AT(ctx, cy, cx) == 0) return 0;
+    }
+    return 1;
+}
+
+// [mode][dy + 2][dx + 2], set when the body offset (dx, dy) is part of the car (see GetCarBody)
+static const bool bodyCells[4][5][5] = {
+    {{0,0,0,0,0},{0,0,0,0,0},{0,0,1,1,0},{0,0,1,1,0},{0,0,1,1,0}},
+    {{0,0,0,0,0},{0,0,0,0,0},{1,1,1,0,0},{1,1,1,0,0},{0,0,0,0,0}},
+    {{0,1,1,0,0},{0,1,1,0,0},{0,1,1,0,0},{0,0,0,0,0},{0,0,0,0,0}},
+    {{0,0,0,0,0},{0,0,1,1,1},{0,0,1,1,1},{0,0,0,0,0},{0,0,0,0,0}}
+};
+
+bool PoseCoversCell(int x, int y, int mode, int cellX, int cellY) {
+    int dx = cellX - x + 2;
+    int dy = cellY - y + 2;
+    if ((unsigned)dx >= 5 || (unsigned)dy >= 5) return false;
+    return bodyCells[mode][dy][dx];
+}
+
+// bit k of coverMask[IDX_POS] is set when that pose covers targets[k]
+void BuildCoverMasks(const SolverContext *ctx, const ActiveTarget *targets, int count, uint32_t *coverMask) {
+    memset(coverMask, 0, (size_t)ctx->rows * ctx->cols * 4 * sizeof(uint32_t));
+    for (int k = 0; k < count; k++) {
+        for (int m = 0; m < 4; m++) {
+            int body[6][2];
+            GetCarBody(m, body);
+            for (int b = 0; b < 6; b++) {
+                int x = targets[k].x - body[b][0];
+                int y = targets[k].y - body[b][1];
+                if (!IsPoseFree(ctx, x, y, m)) continue;
+                coverMask[IDX_POS(y, x, m, ctx->cols)] |= (uint32_t)1 << k;
+            }
+        }
+    }
+}
+
+// BuildCoverMasks over the dense ids of ctx->poseIndex, unreachable covering poses are left out
+void BuildDenseCoverMasks(const SolverContext *ctx, const ActiveTarget *targets, int count, uint32_t *coverMask) {
+    const PoseIndex *index = &ctx->poseIndex;
+    memset(coverMask, 0, index->count * sizeof(uint32_t));
+    for (int k = 0; k < count; k++) {
+        for (int m = 0; m < 4; m++) {
+            int body[6][2];
+            GetCarBody(m, body);
+            for (int b = 0; b < 6; b++) {
+                int x = targets[k].x - body[b][0];
+                int y = targets[k].y - body[b][1];
+                if (!IsPoseFree(ctx, x, y, m)) continue;
+                size_t id = DensePoseId(index, IDX_POS(y, x, m, ctx->cols));
+                if (id != POSE_NONE) coverMask[id] |= (uint32_t)1 << k;
+            }
+        }
+    }
+}
+
+// collision test for every pose, once per maze
+void BuildPoseTable(SolverContext *ctx) {
+    size_t totalPoses = (size_t)ctx->rows * ctx->cols * 4;
+    free(ctx->poseFree);
+    ctx->poseFree = (uint64_t*)calloc((totalPoses + 63) / 64, sizeof(uint64_t));
+    for (int r = 0; r < ctx->rows; r++) {
+        for (int c = 0; c < ctx->cols; c++) {
+            for (int m = 0; m < 4; m++) {
+                if (CheckCarCollision(ctx, c, r, m)) {
+                    size_t idx = IDX_POS(r, c, m, ctx->cols);
+                    ctx->poseFree[idx >> 6] |= (uint64_t)1 << (idx & 63);
+                }
+            }
+        }
+    }
+}
+
+// what a search stops at
+typedef enum { GoalCell = 0, GoalPose, GoalCells, GoalNone } GoalKind;
+typedef struct {
+    GoalKind kind;
+    int x, y, mode;
+    // GoalCells: cellTarget[r * cols + c] is the slot of the target on that cell or -1,
+    // costs[slot] receives the first cost that covers it, search stops once remaining hits 0
+    const int *cellTarget;
+    int *costs;
+    int remaining;
+} SearchGoal;
+
+// slot of pose idx in the search arrays, its dense id when the search runs on the pose index
+static inline size_t SearchSlot(const PoseIndex *dense, size_t idx) {
+    return dense ? DensePoseId(dense, idx) : idx;
+}
+
+// dist and parent (optional, ENCODE_PARENT codes) hold rows*cols*4 entries, or dense->count
+// when dense is set and start is reachable. Returns the goal cost or -1, endStateIdx is an
+// IDX_POS. counters (optional) receive the pop and relaxation counts of the search.
+static int RunDijkstra(const SolverContext *ctx, State start, SearchGoal *goal, PQueue *pq, int *dist, uint8_t *parent, size_t *endStateIdx, SearchCounters *counters, const PoseIndex *dense) {
+    int cols = ctx->cols;
+    size_t totalStates = dense ? dense->count : (size_t)ctx->rows * cols * 4;
+
+    for(size_t i=0; i<totalStates; i++) dist[i] = INT_MAX;
+    if(parent) memset(parent, PARENT_NONE, totalStates);
+
+    clearPQueue(pq);
+    size_t startIdx = IDX_POS(start.y, start.x, start.mode, cols);
+    dist[SearchSlot(dense, startIdx)] = 0;
+    pushPQueue(pq, (PQNode){start.x, start.y, start.mode, 0, 0});
+
+    int finalCost = -1;
+    size_t pops = 0, stalePops = 0, relaxations = 0;
+    int queuePeak = 0;
+
+    while(!isPQueueEmpty(pq)) {
+        if((++pops & (PROGRESS_INTERVAL - 1)) == 0 && SolveCancelled(ctx)) break;
+        if(sizePQueue(pq) > queuePeak) queuePeak = sizePQueue(pq);
+        PQNode u = popPQueue(pq);
+        size_t uIdx = IDX_POS(u.y, u.x, u.mode, cols);
+        if(u.cost > dist[SearchSlot(dense, uIdx)]) { stalePops++; continue; }
+        bool hit = false;
+        if(goal->kind == GoalCell) hit = PoseCoversCell(u.x, u.y, u.mode, goal->x, goal->y);
+        else if(goal->kind == GoalPose) hit = (u.x == goal->x && u.y == goal->y && u.mode == goal->mode);
+        else if(goal->kind == GoalCells) {
+            for(int b=0; b<6; b++) {
+                int cx = u.x + carBody[u.mode][b][0];
+                int cy = u.y + carBody[u.mode][b][1];
+                if((unsigned)cx >= (unsigned)cols || (unsigned)cy >= (unsigned)ctx->rows) continue;
+                int slot = goal->cellTarget[(size_t)cy * cols + cx];
+                if(slot >= 0 && goal->costs[slot] == -1) {
+                    goal->costs[slot] = u.cost;
+                    goal->remaining--;
+                }
+            }
+            hit = goal->remaining == 0;
+        }
+        if(hit) {
+            finalCost = u.cost;
+            if(endStateIdx) *endStateIdx = uIdx;
+            break;
+        }
+        for(int i=0; i<8; i++) {
+            int nextMode = ctx->moves[u.mode][i][0];
+            int dx = ctx->moves[u.mode][i][1];
+            int dy = ctx->moves[u.mode][i][2];
+            int fuel = ctx->moves[u.mode][i][3];
+            int nx = u.x + dx;
+            int ny = u.y + dy;
+
+            size_t vSlot;
+            if(dense) {
+                // every reachable pose is free, so the index doubles as the legality test
+                if((unsigned)nx >= (unsigned)cols || (unsigned)ny >= (unsigned)ctx->rows) continue;
+                vSlot = DensePoseId(dense, IDX_POS(ny, nx, nextMode, cols));
+                if(vSlot == POSE_NONE) continue;
+            } else {
+                if(!IsPoseFree(ctx, nx, ny, nextMode)) continue;
+                vSlot = IDX_POS(ny, nx, nextMode, cols);
+            }
+            int newCost = u.cost + fuel;
+            if(newCost < dist[vSlot]) {
+                dist[vSlot] = newCost;
+                if(parent) parent[vSlot] = ENCODE_PARENT(u.mode, i);
+                pushPQueue(pq, (PQNode){nx, ny, nextMode, 0, newCost});
+                relaxations++;
+            }
+        }
+    }
+
+    if(counters) {
+        SearchCounters run = {1, pops, stalePops, relaxations, (size_t)queuePeak};
+        addSearchCounters(counters, &run);
+    }
+    return finalCost;
+}
+
+// pose the move stored in code was taken from
+static inline State ParentPose(const SolverContext *ctx, State s, uint8_t code) {
+    const int *mv = ctx->moves[PARENT_MODE(code)][PARENT_MOVE(code)];
+    return (State){s.x - mv[1], s.y - mv[2], PARENT_MODE(code)};
+}
+
+// replay parent moves back from end, the start pose itself is not included
+static void ReconstructLeg(const SolverContext *ctx, const uint8_t *parent, const PoseIndex *dense, State end, PathStep **outPath, int *outStepCount) {
+    int cols = ctx->cols;
+    // count first, legs on large mazes have no useful upper bound
+    int steps = 0;
+    for(State s = end; parent[SearchSlot(dense, IDX_POS(s.y, s.x, s.mode, cols))] != PARENT_NONE; steps++) {
+        s = ParentPose(ctx, s, parent[SearchSlot(dense, IDX_POS(s.y, s.x, s.mode, cols))]);
+    }
+
+    // fill back to front
+    *outStepCount = steps;
+    *outPath = (PathStep*)malloc(sizeof(PathStep) * (steps > 0 ? steps : 1));
+    State s = end;
+    for(int k = steps - 1; k >= 0; k--) {
+        (*outPath)[k] = (PathStep){s.x, s.y, s.mode};
+        s = ParentPose(ctx, s, parent[SearchSlot(dense, IDX_POS(s.y, s.x, s.mode, cols))]);
+    }
+}
+
+const PoseIndex *SearchPoseIndex(const SolverContext *ctx, State start) {
+    const PoseIndex *index = &ctx->poseIndex;
+    size_t totalPoses = (size_t)ctx->rows * ctx->cols * 4;
+    if(!index->bits || index->count * DENSE_SEARCH_RATIO > totalPoses) return NULL;
+    if(!IsPoseFree(ctx, start.x, start.y, start.mode)) return NULL;
+    return DensePoseId(index, IDX_POS(start.y, start.x, start.mode, ctx->cols)) != POSE_NONE ? index : NULL;
+}
+
+static int SearchLeg(const SolverContext *ctx, State start, SearchGoal goal, PathStep **outPath, int *outStepCount) {
+    const PoseIndex *dense = SearchPoseIndex(ctx, start);
+    size_t totalStates = dense ? dense->count : (size_t)ctx->rows * ctx->cols * 4;
+    bool wantPath = outPath && outStepCount;
+    int *dist = (int*)malloc(totalStates * sizeof(int));
+    uint8_t *parent = wantPath ? (uint8_t*)malloc(totalStates) : NULL;
+
+    size_t endStateIdx = SIZE_MAX;
+    PQueue *pq = createSearchQueue(ctx);
+    int finalCost = RunDijkstra(ctx, start, &goal, pq, dist, parent, &endStateIdx, DijkstraCounters(ctx), dense);
+    freePQueue(pq);
+
+    // reconstruct
+    if(wantPath && finalCost != -1) {
+        State end = {(int)((endStateIdx / 4) % ctx->cols), (int)((endStateIdx / 4) / ctx->cols), (int)(endStateIdx % 4)};
+        ReconstructLeg(ctx, parent, dense, end, outPath, outStepCount);
+    }
+
+    free(dist);
+    free(parent);
+    return finalCost;
+}
+
+int Dijkstra(const SolverContext *ctx, int startX, int startY, int startMode, int targetX, int targetY, PathStep** outPath, int* outStepCount) {
+    return SearchLeg(ctx, (State){startX, startY, startMode}, (SearchGoal){GoalCell, targetX, targetY, 0, NULL, NULL, 0}, outPath, outStepCount);
+}
+
+int DijkstraToPose(const SolverContext *ctx, int startX, int startY, int startMode, int targetX, int targetY, int targetMode, PathStep** outPath, int* outStepCount) {
+    return SearchLeg(ctx, (State){startX, startY, startMode}, (SearchGoal){GoalPose, targetX, targetY, targetMode, NULL, NULL, 0}, outPath, outStepCount);
+}
+
+void DijkstraAll(const SolverContext *ctx, int startX, int startY, int startMode, int *dist) {
+    SearchGoal goal = {GoalNone, 0, 0, 0, NULL, NULL, 0};
+    PQueue *pq = createSearchQueue(ctx);
+    RunDijkstra(ctx, (State){startX, startY, startMode}, &goal, pq, dist, NULL, NULL, DijkstraCounters(ctx), NULL);
+    freePQueue(pq);
+}
+
+void DijkstraAllSlots(const SolverContext *ctx, State start, const PoseIndex *dense, int *dist) {
+    SearchGoal goal = {GoalNone, 0, 0, 0, NULL, NULL, 0};
+    PQueue *pq = createSearchQueue(ctx);
+    RunDijkstra(ctx, start, &goal, pq, dist, NULL, NULL, DijkstraCounters(ctx), dense);
+    freePQueue(pq);
+}
+
+void InitSearchScratch(const SolverContext *ctx, SearchScratch *scratch) {
+    size_t cells = (size_t)ctx->rows * ctx->cols;
+    scratch->dist = (int*)malloc(cells * 4 * sizeof(int));
+    scratch->cellTarget = (int*)malloc(cells * sizeof(int));
+    for(size_t i=0; i<cells; i++) scratch->cellTarget[i] = -1;
+    scratch->pq = createSearchQueue(ctx);
+    memset(&scratch->counters, 0, sizeof(scratch->counters));
+}
+
+void FreeSearchScratch(SearchScratch *scratch) {
+    free(scratch->dist);
+    free(scratch->cellTarget);
+    if(scratch->pq) freePQueue(scratch->pq);
+    scratch->dist = NULL;
+    scratch->cellTarget = NULL;
+    scratch->pq = NULL;
+}
+
+void OneToManyWithScratch(const SolverContext *ctx, SearchScratch *scratch, State start, const ActiveTarget *targets, int count, int *outCosts) {
+    for(int t=0; t<count; t++) {
+        scratch->cellTarget[(size_t)targets[t].y * ctx->cols + targets[t].x] = t;
+        outCosts[t] = -1;
+    }
+
+    SearchGoal goal = {GoalCells, 0, 0, 0, scratch->cellTarget, outCosts, count};
+    if(count > 0) RunDijkstra(ctx, start, &goal, scratch->pq, scratch->dist, NULL, NULL, &scratch->counters, NULL);
+
+    for(int t=0; t<count; t++) scratch->cellTarget[(size_t)targets[t].y * ctx->cols + targets[t].x] = -1;
+}
+
+// one search for a whole row of costs, expands until every target cell is covered
+void DijkstraOneToMany(const SolverContext *ctx, int startX, int startY, int startMode, const ActiveTarget *targets, int count, int *outCosts) {
+    SearchScratch scratch;
+    InitSearchScratch(ctx, &scratch);
+    OneToManyWithScratch(ctx, &scratch, (State){startX, startY, startMode}, targets, count, outCosts);
+    if(ctx->stats) addSearchCounters(&ctx->stats->dijkstra, &scratch.counters);
+    FreeSearchScratch(&scratch);
+}
+
+void InitLegScratch(const SolverContext *ctx, LegScratch *scratch) {
+    size_t totalStates = (size_t)ctx->rows * ctx->cols * 4;
+    scratch->dist = (int*)malloc(totalStates * 2 * sizeof(int));
+    scratch->code = (uint8_t*)malloc(totalStates * 2);
+    for(size_t i=0; i<totalStates * 2; i++) scratch->dist[i] = INT_MAX;
+    for(int d=0; d<2; d++) scratch->pq[d] = createSearchQueue(ctx);
+    for(int m=0; m<4; m++) {
+        scratch->reverseCount[m] = 0;
+        for(int pm=0; pm<4; pm++)
+            for(int i=0; i<8; i++)
+                if(ctx->moves[pm][i][0] == m) scratch->reverse[m][scratch->reverseCount[m]++] = ENCODE_PARENT(pm, i);
+    }
+    scratch->touchedCap = 1024;
+    scratch->touchedCount = 0;
+    scratch->touched = (size_t*)malloc(scratch->touchedCap * sizeof(size_t));
+}
+
+void FreeLegScratch(LegScratch *scratch) {
+    free(scratch->dist);
+    free(scratch->code);
+    scratch->dist = NULL;
+    scratch->code = NULL;
+    for(int d=0; d<2; d++) {
+        if(scratch->pq[d]) freePQueue(scratch->pq[d]);
+        scratch->pq[d] = NULL;
+    }
+    free(scratch->touched);
+    scratch->touched = NULL;
+    scratch->touchedCount = scratch->touchedCap = 0;
+}
+
+// sets the dir side of pose idx, remembering first visits so the next leg only resets what this one used
+static inline void SetLegDist(LegScratch *scratch, int dir, size_t idx, int d, uint8_t code) {
+    if(scratch->dist[LEG_SLOT(idx, dir)] == INT_MAX) {
+        if(scratch->touchedCount == scratch->touchedCap) {
+            scratch->touchedCap *= 2;
+            scratch->touched = (size_t*)realloc(scratch->touched, scratch->touchedCap * sizeof(size_t));
+        }
+        scratch->touched[scratch->touchedCount++] = idx;
+    }
+    scratch->dist[LEG_SLOT(idx, dir)] = d;
+    scratch->code[LEG_SLOT(idx, dir)] = code;
+}
+
+// relax the neighbours of u on side dir (forward moves for 0, reversed moves for 1)
+static inline void ExpandLegSide(const SolverContext *ctx, LegScratch *scratch, int dir, PQNode u, int otherKey, int *mu, size_t *meet) {
+    int cols = ctx->cols;
+    int *dist = scratch->dist;
+    int edgeCount = dir == 0 ? 8 : scratch->reverseCount[u.mode];
+    for(int e=0; e<edgeCount; e++) {
+        // forward takes move e of u.mode, backward the e-th (mode, move) pair that ends in u.mode
+        uint8_t code = dir == 0 ? ENCODE_PARENT(u.mode, e) : scratch->reverse[u.mode][e];
+        const int *mv = ctx->moves[PARENT_MODE(code)][PARENT_MOVE(code)];
+        int nx, ny, nm;
+        if(dir == 0) { nx = u.x + mv[1]; ny = u.y + mv[2]; nm = mv[0]; }
+        else { nx = u.x - mv[1]; ny = u.y - mv[2]; nm = PARENT_MODE(code); }
+        if(!IsPoseFree(ctx, nx, ny, nm)) continue;
+        int newCost = u.cost + mv[3];
+        size_t vIdx = IDX_POS(ny, nx, nm, cols);
+        if(newCost >= dist[LEG_SLOT(vIdx, dir)]) continue;
+        int other = dist[LEG_SLOT(vIdx, 1 - dir)];
+        if(other != INT_MAX && newCost + other < *mu) { *mu = newCost + other; *meet = vIdx; }
+        // the rest of any path through v costs at least the other side's last key
+        if(other == INT_MAX && newCost + otherKey >= *mu) continue;
+        // forward stores the move that led here, backward the move that leads on
+        SetLegDist(scratch, dir, vIdx, newCost, dir == 0 ? code : (uint8_t)PARENT_MOVE(code));
+        pushPQueue(scratch->pq[dir], (PQNode){nx, ny, nm, 0, newCost});
+    }
+}
+
+// Forward from start, backward over reversed moves from every pose covering the target.
+// mu is the best start-to-target cost through a pose labelled by both sides; once the
+// last keys popped on each side add up to mu no shorter path can exist.
+int BidirectionalLegWithScratch(const SolverContext *ctx, LegScratch *scratch, State start, int targetX, int targetY, PathStep **outPath, int *outStepCount) {
+    int cols = ctx->cols;
+    int *dist = scratch->dist;
+    const uint8_t *codes = scratch->code;
+    for(int d=0; d<2; d++) clearPQueue(scratch->pq[d]);
+
+    int mu = INT_MAX;
+    size_t meet = SIZE_MAX;
+    size_t startIdx = IDX_POS(start.y, start.x, start.mode, cols);
+    SetLegDist(scratch, 0, startIdx, 0, PARENT_NONE);
+    pushPQueue(scratch->pq[0], (PQNode){start.x, start.y, start.mode, 0, 0});
+    for(int m=0; m<4; m++) {
+        for(int b=0; b<6; b++) {
+            int x = targetX - carBody[m][b][0];
+            int y = targetY - carBody[m][b][1];
+            if(!IsPoseFree(ctx, x, y, m)) continue;
+            size_t idx = IDX_POS(y, x, m, cols);
+            SetLegDist(scratch, 1, idx, 0, PARENT_NONE);
+            pushPQueue(scratch->pq[1], (PQNode){x, y, m, 0, 0});
+            if(idx == startIdx) { mu = 0; meet = idx; }
+        }
+    }
+
+    int lastKey[2] = {0, 0};
+    while(mu > 0 && (!isPQueueEmpty(scratch->pq[0]) || !isPQueueEmpty(scratch->pq[1]))) {
+        // grow the side that has searched the smaller radius
+        int dir;
+        if(isPQueueEmpty(scratch->pq[0])) dir = 1;
+        else if(isPQueueEmpty(scratch->pq[1])) dir = 0;
+        else dir = lastKey[0] <= lastKey[1] ? 0 : 1;
+
+        PQNode u = popPQueue(scratch->pq[dir]);
+        if(u.cost > dist[LEG_SLOT(IDX_POS(u.y, u.x, u.mode, cols), dir)]) continue;
+        lastKey[dir] = u.cost;
+        if(lastKey[0] + lastKey[1] >= mu) break;
+
+        // constant dir per call so each side gets its own specialised loop
+        if(dir == 0) ExpandLegSide(ctx, scratch, 0, u, lastKey[1], &mu, &meet);
+        else ExpandLegSide(ctx, scratch, 1, u, lastKey[0], &mu, &meet);
+    }
+
+    int finalCost = (meet == SIZE_MAX) ? -1 : mu;
+    if(finalCost != -1 && outPath && outStepCount) {
+        State mid = {(int)((meet / 4) % cols), (int)((meet / 4) / cols), (int)(meet % 4)};
+        int head = 0, tail = 0;
+        for(State s = mid; codes[LEG_SLOT(IDX_POS(s.y, s.x, s.mode, cols), 0)] != PARENT_NONE; head++) {
+            s = ParentPose(ctx, s, codes[LEG_SLOT(IDX_POS(s.y, s.x, s.mode, cols), 0)]);
+        }
+        for(State s = mid; codes[LEG_SLOT(IDX_POS(s.y, s.x, s.mode, cols), 1)] != PARENT_NONE; tail++) {
+            const int *mv = ctx->moves[s.mode][codes[LEG_SLOT(IDX_POS(s.y, s.x, s.mode, cols), 1)]];
+            s = (State){s.x + mv[1], s.y + mv[2], mv[0]};
+        }
+
+        // start side back to front up to the meeting pose, then the target side in order
+        int steps = head + tail;
+        PathStep *path = (PathStep*)malloc(sizeof(PathStep) * (steps > 0 ? steps : 1));
+        State s = mid;
+        for(int k = head - 1; k >= 0; k--) {
+            path[k] = (PathStep){s.x, s.y, s.mode};
+            s = ParentPose(ctx, s, codes[LEG_SLOT(IDX_POS(s.y, s.x, s.mode, cols), 0)]);
+        }
+        s = mid;
+        for(int k = head; k < steps; k++) {
+            const int *mv = ctx->moves[s.mode][codes[LEG_SLOT(IDX_POS(s.y, s.x, s.mode, cols), 1)]];
+            s = (State){s.x + mv[1], s.y + mv[2], mv[0]};
+            path[k] = (PathStep){s.x, s.y, s.mode};
+        }
+        *outPath = path;
+        *outStepCount = steps;
+    }
+
+    // scattered resets cost a cache miss each, past a few percent of the grid a sweep is cheaper
+    size_t totalStates = (size_t)ctx->rows * cols * 4;
+    if(scratch->touchedCount > totalStates / 32) {
+        for(size_t i=0; i<totalStates * 2; i++) dist[i] = INT_MAX;
+    } else {
+        for(size_t t=0; t<scratch->touchedCount; t++) {
+            dist[LEG_SLOT(scratch->touched[t], 0)] = INT_MAX;
+            dist[LEG_SLOT(scratch->touched[t], 1)] = INT_MAX;
+        }
+    }
+    scratch->touchedCount = 0;
+    return finalCost;
+}
+
+int DijkstraBidirectional(const SolverContext *ctx, int startX, int startY, int startMode, int targetX, int targetY, PathStep** outPath, int* outStepCount) {
+    LegScratch scratch;
+    InitLegScratch(ctx, &scratch);
+    int cost = BidirectionalLegWithScratch(ctx, &scratch, (State){startX, startY, startMode}, targetX, targetY, outPath, outStepCount);
+    FreeLegScratch(&scratch);
+    return cost;
+}
+
+// accessibility check (BFS)
+bool MarkReachable(SolverContext *ctx) {
+    int rows = ctx->rows, cols = ctx->cols;
+    size_t totalPoses = (size_t)rows * cols * 4;
+    size_t bitWords = (size_t)rows * 4 * ((cols + 63) / 64);
+    size_t poseWords = (totalPoses + 63) / 64;
+    uint64_t *reach = (uint64_t*)malloc((bitWords > 0 ? bitWords : 1) * sizeof(uint64_t));
+    uint64_t *bits = (uint64_t*)malloc((poseWords > 0 ? poseWords : 1) * sizeof(uint64_t));
+    free(ctx->visited);
+    ctx->visited = (bool*)calloc(totalPoses, sizeof(bool));
+    ctx->reachableCount = 0;
+    for(int i=0; i<ctx->objCount; i++) ctx->objectives[i].reachable = false;
+    if (!reach || !bits || !ctx->visited || !ReachablePoseBits(ctx, ctx->start_state, reach)) {
+        free(reach);
+        free(bits);
+        return false;
+    }
+    ReachToPoseBits(ctx, reach, bits);
+    free(reach);
+    for (size_t w = 0; w < poseWords; w++) {
+        for (uint64_t set = bits[w]; set; set &= set - 1) ctx->visited[w * 64 + (size_t)PopCount64((set & -set) - 1)] = true;
+    }
+
+    MarkReachableObjectives(ctx);
+    BuildPoseIndex(ctx, bits);
+    return true;
+}
+
+// an objective is reachable when the car can stand on it in any mode
+void MarkReachableObjectives(SolverContext *ctx) {
+    ctx->reachableCount = 0;
+    for(int i=0; i<ctx->objCount; i++) {
+        Objective *o = &ctx->objectives[i];
+        o->reachable = false;
+        for(int m=0; m<4 && !o->reachable; m++) o->reachable = ctx->visited[IDX_POS(o->y, o->x, m, ctx->cols)];
+        if(o->reachable) ctx->reachableCount++;
+    }
+}
+
+void CheckAccessibility(SolverContext *ctx) {
+    double statsStart = StatsStart(ctx);
+    int rows = ctx->rows, cols = ctx->cols;
+    size_t totalPoses = (size_t)rows * cols * 4;
+    size_t bitWords = (size_t)rows * 4 * ((cols + 63) / 64);
+    size_t poseWords = (totalPoses + 63) / 64;
+
+    CollectObjectives(ctx);
+    ProgressPhase(ctx, PHASE_ACCESSIBILITY, 0);
+    // out of memory or cancelled: a partial search must not strike objectives from the maze
+    if (!MarkReachable(ctx)) return;
+    for(int i=0; i<ctx->objCount; i++) {
+        if(!ctx->objectives[i].reachable) MAZE_AT(ctx, ctx->objectives[i].y, ctx->objectives[i].x) = 1;
+    }
+
+    // reach, the free/pending bitsets and the worklist, then visited and the index
+    StatsStop(ctx, STATS_ACCESSIBILITY, statsStart, bitWords * 4 * sizeof(uint64_t) + (size_t)rows * 4 * (2 * sizeof(int) + sizeof(size_t))
+              + totalPoses * sizeof(bool) + ctx->objCount * sizeof(Objective)
+              + poseWords * (sizeof(uint64_t) + sizeof(size_t)) + ctx->poseIndex.count * sizeof(size_t));
+}
+
+void FreePoseIndex(PoseIndex *index) {
+    free(index->bits);
+    free(index->rank);
+    free(index->pose);
+    memset(index, 0, sizeof(*index));
+}
+
+// numbers the set poses of bits in IDX_POS order
+void BuildPoseIndex(SolverContext *ctx, uint64_t *bits) {
+    PoseIndex *index = &ctx->poseIndex;
+    FreePoseIndex(index);
+    size_t words = ((size_t)ctx->rows * ctx->cols * 4 + 63) / 64;
+    index->bits = bits;
+    index->rank = (size_t*)malloc((words > 0 ? words : 1) * sizeof(size_t));
+    if(!index->bits || !index->rank) { FreePoseIndex(index); return; }
+    for(size_t w=0; w<words; w++) {
+        index->rank[w] = index->count;
+        index->count += (size_t)PopCount64(index->bits[w]);
+    }
+    if(!ListIndexPoses(ctx)) FreePoseIndex(index);
+}
+
+bool ListIndexPoses(SolverContext *ctx) {
+    PoseIndex *index = &ctx->poseIndex;
+    if(index->pose) return true;
+    size_t words = ((size_t)ctx->rows * ctx->cols * 4 + 63) / 64;
+    index->pose = (size_t*)malloc((index->count > 0 ? index->count : 1) * sizeof(size_t));
+    if(!index->pose) return false;
+    size_t id = 0;
+    for(size_t w=0; w<words; w++) {
+        for(uint64_t set = index->bits[w]; set; set &= set - 1) index->pose[id++] = w * 64 + (size_t)PopCount64((set & -set) - 1);
+    }
+    return true;
+}
+
+// ranks before the first toggled word still hold, the rest are counted again
+void TogglePoseIndex(SolverContext *ctx, const size_t *toggled, size_t count) {
+    PoseIndex *index = &ctx->poseIndex;
+    if(!index->bits || count == 0) return;
+    size_t words = ((size_t)ctx->rows * ctx->cols * 4 + 63) / 64;
+    size_t from = words;
+    for(size_t i=0; i<count; i++) {
+        index->bits[toggled[i] >> 6] ^= (uint64_t)1 << (toggled[i] & 63);
+        if((toggled[i] >> 6) < from) from = toggled[i] >> 6;
+    }
+    size_t id = index->rank[from];
+    for(size_t w=from; w<words; w++) {
+        index->rank[w] = id;
+        id += (size_t)PopCount64(index->bits[w]);
+    }
+    index->count = id;
+    free(index->pose);
+    index->pose = NULL;
+}
+
+// every objective cell of the maze, none marked reachable yet
+void CollectObjectives(SolverContext *ctx) {
+    int objCount = 0;
+    for(size_t i=0; i<(size_t)ctx->rows * ctx->cols; i++) if(ctx->maze[i] == 3) objCount++;
+    free(ctx->objectives);
+    ctx->objectives = (Objective*)malloc((objCount > 0 ? objCount : 1) * sizeof(Objective));
+    ctx->objCount = 0;
+    for(int r=0; r<ctx->rows; r++){
+        for(int c=0; c<ctx->cols; c++){
+            if(MAZE_AT(ctx, r, c) == 3) {
+                ctx->objectives[ctx->objCount].x = c;
+                ctx->objectives[ctx->objCount].y = r;
+                ctx->objectives[ctx->objCount].reachable = false;
+                ctx->objCount++;
+            }
+        }
+    }
+}
+
+// collect reachable objectives, returns count
+int CollectActiveTargets(const SolverContext *ctx, ActiveTarget *activeTargets) {
+    int activeCount = 0;
+    for (int i = 0; i < ctx->objCount; i++) {
+        if (ctx->objectives[i].reachable) {
+            activeTargets[activeCount].x = ctx->objectives[i].x;
+            activeTargets[activeCount].y = ctx->objectives[i].y;
+            activeTargets[activeCount].originalIdx = i;
+            activeCount++;
+        }
+    }
+    return activeCount;
+}
+
+// Exact TSP (Bitmask Dijkstra)
+static State DecodeIndex(const SolverContext *ctx, size_t idx, int *mask, int maxMask) {
+    size_t pose = ctx->poseIndex.pose[idx / maxMask];
+    *mask = (int)(idx % maxMask);
+    return (State){(int)((pose / 4) % ctx->cols), (int)((pose / 4) / ctx->cols), (int)(pose % 4)};
+}
+
+// Undo the stored move of (pose, mask). The previous mask lies between mask minus the
+// pose cover and mask itself; the candidate whose cost plus the move fuel matches is on
+// a shortest path. Returns SIZE_MAX at the start state.
+static size_t ExactPredecessor(const SolverContext *ctx, const StateStore *store, const uint32_t *coverMask, size_t idx, int maxMask) {
+    int mask;
+    State s = DecodeIndex(ctx, idx, &mask, maxMask);
+    uint8_t code = getStateParent(store, idx);
+    if (code == PARENT_NONE) return SIZE_MAX;
+
+    State prev = ParentPose(ctx, s, code);
+    size_t prevId = DensePoseId(&ctx->poseIndex, IDX_POS(prev.y, prev.x, prev.mode, ctx->cols));
+    int target = getStateDist(store, idx) - ctx->moves[prev.mode][PARENT_MOVE(code)][3];
+    int cover = (int)coverMask[idx / maxMask];
+    int need = mask & ~cover;
+    int optional = mask & cover;
+    int sub = optional;
+    while (1) {
+        size_t pIdx = GET_IDX(prevId, need | sub, maxMask);
+        if (getStateDist(store, pIdx) == target) return pIdx;
+        if (sub == 0) break;
+        sub = (sub - 1) & optional;
+    }
+    return SIZE_MAX;
+}
+
+// A* lower bound for the exact search: fuel to the nearest target still missing plus
+// the MST over the missing targets. Both parts only use distances the walk must still
+// pay, so the bound is admissible and consistent and A* keeps the optimum.
+#define EXACT_H_INF (INT_MAX / 4)
+
+typedef struct {
+    int count;
+    size_t poseCount;
+    int *targetDist;    // [target * poseCount + dense pose id] fuel until the body covers the target
+    int *pairDist;      // [a * count + b] fuel between poses covering a and b, either direction
+    int *mstCost;       // [missing mask] MST weight over pairDist, -1 until needed
+} ExactHeuristic;
+
+// fuel from every reachable pose to the nearest pose covering target bit, by searching
+// the reversed moves. Forward paths from a reachable pose stay reachable, so the search
+// can skip every other pose.
+static void ReverseCoverDistances(const SolverContext *ctx, const uint32_t *coverMask, int bit, PQueue *pq, int *dist) {
+    int cols = ctx->cols;
+    const PoseIndex *index = &ctx->poseIndex;
+    clearPQueue(pq);
+    for (size_t i = 0; i < index->count; i++) {
+        dist[i] = INT_MAX;
+        if ((coverMask[i] >> bit) & 1) {
+            size_t p = index->pose[i];
+            dist[i] = 0;
+            pushPQueue(pq, (PQNode){(int)((p / 4) % cols), (int)((p / 4) / cols), (int)(p % 4), 0, 0});
+        }
+    }
+    size_t pops = 0;
+    while (!isPQueueEmpty(pq)) {
+        if ((++pops & (PROGRESS_INTERVAL - 1)) == 0 && SolveCancelled(ctx)) break;
+        PQNode u = popPQueue(pq);
+        if (u.cost > dist[DensePoseId(index, IDX_POS(u.y, u.x, u.mode, cols))]) continue;
+        for (int pm = 0; pm < 4; pm++) {
+            for (int i = 0; i < 8; i++) {
+                const int *mv = ctx->moves[pm][i];
+                if (mv[0] != u.mode) continue;
+                int px = u.x - mv[1];
+                int py = u.y - mv[2];
+                if (!IsPoseFree(ctx, px, py, pm)) continue;
+                size_t pId = DensePoseId(index, IDX_POS(py, px, pm, cols));
+                if (pId == POSE_NONE) continue;
+                int newCost = u.cost + mv[3];
+                if (newCost < dist[pId]) {
+                    dist[pId] = newCost;
+                    pushPQueue(pq, (PQNode){px, py, pm, 0, newCost});
+                }
+            }
+        }
+    }
+}
+
+static void FreeExactHeuristic(ExactHeuristic *h) {
+    free(h->targetDist);
+    free(h->pairDist);
+    free(h->mstCost);
+    memset(h, 0, sizeof(*h));
+}
+
+static bool InitExactHeuristic(const SolverContext *ctx, const uint32_t *coverMask, int count, ExactHeuristic *h) {
+    size_t P = ctx->poseIndex.count;
+    h->count = count;
+    h->poseCount = P;
+    h->targetDist = (int*)malloc((size_t)count * P * sizeof(int));
+    h->pairDist = (int*)malloc((size_t)count * count * sizeof(int));
+    h->mstCost = (int*)malloc(((size_t)1 << count) * sizeof(int));
+    if (!h->targetDist || !h->pairDist || !h->mstCost) { FreeExactHeuristic(h); return false; }
+
+    PQueue *pq = createSearchQueue(ctx);
+    for (int t = 0; t < count; t++) {
+        int *dist = h->targetDist + (size_t)t * P;
+        ReverseCoverDistances(ctx, coverMask, t, pq, dist);
+        for (size_t i = 0; i < P; i++) if (dist[i] > EXACT_H_INF) dist[i] = EXACT_H_INF;
+        if (!ProgressStep(ctx)) { freePQueue(pq); FreeExactHeuristic(h); return false; }
+    }
+    freePQueue(pq);
+
+    for (int i = 0; i < count * count; i++) h->pairDist[i] = EXACT_H_INF;
+    for (size_t p = 0; p < P; p++) {
+        uint32_t cover = coverMask[p];
+        if (cover == 0) continue;
+        for (int a = 0; a < count; a++) {
+            if (!((cover >> a) & 1)) continue;
+            for (int b = 0; b < count; b++) {
+                int d = h->targetDist[(size_t)b * P + p];
+                if (d < h->pairDist[a * count + b]) h->pairDist[a * count + b] = d;
+            }
+        }
+    }
+    for (int a = 0; a < count; a++) {
+        for (int b = 0; b < a; b++) {
+            int d = h->pairDist[a * count + b] < h->pairDist[b * count + a] ? h->pairDist[a * count + b] : h->pairDist[b * count + a];
+            h->pairDist[a * count + b] = h->pairDist[b * count + a] = d;
+        }
+    }
+    for (size_t m = 0; m < ((size_t)1 << count); m++) h->mstCost[m] = -1;
+    return true;
+}
+
+// Prim over the targets in mask
+static int MissingTreeCost(ExactHeuristic *h, int mask) {
+    if (h->mstCost[mask] >= 0) return h->mstCost[mask];
+    int n = h->count;
+    int key[32];
+    int first = -1;
+    for (int t = 0; t < n; t++) {
+        key[t] = EXACT_H_INF;
+        if (first < 0 && ((mask >> t) & 1)) first = t;
+    }
+    int total = 0;
+    int inTree = 0;
+    int cur = first;
+    while (cur >= 0) {
+        inTree |= 1 << cur;
+        int next = -1;
+        for (int t = 0; t < n; t++) {
+            if (!((mask >> t) & 1) || ((inTree >> t) & 1)) continue;
+            if (h->pairDist[cur * n + t] < key[t]) key[t] = h->pairDist[cur * n + t];
+            if (next < 0 || key[t] < key[next]) next = t;
+        }
+        if (next >= 0) total += key[next];
+        if (total > EXACT_H_INF) total = EXACT_H_INF;
+        cur = next;
+    }
+    h->mstCost[mask] = total;
+    return total;
+}
+
+// remaining fuel lower bound for (pose, mask), EXACT_H_INF when a missing target cannot be reached
+static int ExactLowerBound(ExactHeuristic *h, size_t pose, int mask) {
+    int missing = ((1 << h->count) - 1) & ~mask;
+    if (missing == 0) return 0;
+    int nearest = EXACT_H_INF;
+    for (int t = 0; t < h->count; t++) {
+        if (!((missing >> t) & 1)) continue;
+        int d = h->targetDist[(size_t)t * h->poseCount + pose];
+        if (d >= EXACT_H_INF) return EXACT_H_INF;
+        if (d < nearest) nearest = d;
+    }
+    int bound = nearest + MissingTreeCost(h, missing);
+    return bound < EXACT_H_INF ? bound : EXACT_H_INF;
+}
+
+bool SolveTSP_Exact(SolverContext *ctx) {
+    SOLVER_LOG(ctx, "\n--- Starting Exact TSP (Reachable Only) ---\n");
+    int cols = ctx->cols;
+    State start = ctx->start_state;
+    ActiveTarget *activeTargets = (ActiveTarget*)malloc((ctx->objCount + 1) * sizeof(ActiveTarget));
+    int activeCount = CollectActiveTargets(ctx, activeTargets);
+
+    if (activeCount == 0) { SOLVER_LOG(ctx, "No reachable objectives.\n"); free(activeTargets); return false; }
+    if (activeCount > 30) {
+        SOLVER_LOG(ctx, "FAILURE: %d targets do not fit the exact solver mask.\n", activeCount);
+        free(activeTargets);
+        return false;
+    }
+    // states are numbered over the reachable poses only
+    const PoseIndex *index = &ctx->poseIndex;
+    size_t startId = index->bits ? DensePoseId(index, IDX_POS(start.y, start.x, start.mode, cols)) : POSE_NONE;
+    if (startId == POSE_NONE || !ListIndexPoses(ctx)) {
+        SOLVER_LOG(ctx, "FAILURE: no reachable pose index, run CheckAccessibility after editing the maze.\n");
+        free(activeTargets);
+        return false;
+    }
+    PathTraceFree(&ctx->tspPath);
+    int maxMask = (1 << activeCount);
+    size_t poses = index->count;
+    size_t totalStates = poses * maxMask;
+    uint32_t *coverMask = (uint32_t*)malloc((poses > 0 ? poses : 1) * sizeof(uint32_t));
+    if (!coverMask) { free(activeTargets); return false; }
+    BuildDenseCoverMasks(ctx, activeTargets, activeCount, coverMask);
+    free(activeTargets);
+
+    // the cover masks and the A* tables stay for the whole search, the store gets what is left
+    size_t budget = SolverMemoryBudget(ctx);
+    size_t fixedBytes = poses * sizeof(uint32_t);
+    size_t heuristicBytes = ((size_t)activeCount * poses + (size_t)activeCount * activeCount + (size_t)maxMask) * sizeof(int);
+
+    ExactHeuristic heur = {0};
+    ProgressPhase(ctx, PHASE_DISTANCES, activeCount);
+    double statsStart = StatsStart(ctx);
+    bool useAStar = ctx->exactHeuristic && fixedBytes + heuristicBytes <= budget && InitExactHeuristic(ctx, coverMask, activeCount, &heur);
+    if (useAStar) {
+        fixedBytes += heuristicBytes;
+        StatsStop(ctx, STATS_HEURISTIC, statsStart, heuristicBytes);
+    }
+    if (SolveCancelled(ctx)) { FreeExactHeuristic(&heur); free(coverMask); return false; }
+    statsStart = StatsStart(ctx);
+
+    // A* settles a small share of the states, so by default it keeps them in the hash map
+    StoreEngine storeEngine = ctx->stateStore;
+    if (storeEngine == STORE_AUTO && useAStar) storeEngine = STORE_HASH;
+    if (storeEngine != STORE_HASH && fixedBytes + totalStates * (sizeof(int) + 1) > budget) {
+        SOLVER_LOG(ctx, "Dense state store exceeds the %zu MB budget, using the hash store.\n", budget >> 20);
+        storeEngine = STORE_HASH;
+    }
+    StateStore store;
+    if (!initStateStore(&store, storeEngine, totalStates)) { FreeExactHeuristic(&heur); free(coverMask); return false; }
+
+    // A* keys g + h can grow by more than one move's fuel per step, which Dial's buckets cannot hold
+    PQueue* pq = useAStar ? createPQueue(PQ_HEAP, 0) : createSearchQueue(ctx);
+    int startMask = (int)coverMask[startId];
+
+    size_t startIdx = GET_IDX(startId, startMask, maxMask);
+    relaxState(&store, startIdx, 0, PARENT_NONE);
+    int startBound = useAStar ? ExactLowerBound(&heur, startId, startMask) : 0;
+    pushPQueue(pq, (PQNode){start.x, start.y, start.mode, startMask, startBound});
+
+    size_t finalStateIdx = SIZE_MAX;
+    int finalMinCost = -1;
+    ctx->expandedStates = 0;
+    size_t tickedAt = SIZE_MAX;
+    SearchCounters counters = {1, 0, 0, 0, 0};
+    bool overBudget = false;
+    // the hash table checks each doubling against what the rest leaves of the budget
+    store.byteLimit = fixedBytes < budget ? budget - fixedBytes : 0;
+    ProgressPhase(ctx, PHASE_SEARCH, 0);
+    while (!isPQueueEmpty(pq)) {
+        if (store.full) {
+            overBudget = stateStoreBytes(&store) * 3 > store.byteLimit;
+            break;
+        }
+        if ((size_t)sizePQueue(pq) > counters.queuePeak) counters.queuePeak = (size_t)sizePQueue(pq);
+        PQNode u = popPQueue(pq);
+        counters.pops++;
+        // keys pop in order, so the popped key bounds the optimum from below. Stale pops
+        // leave the count where it is and do not tick again.
+        if ((ctx->expandedStates & (PROGRESS_INTERVAL - 1)) == 0 && ctx->expandedStates != tickedAt) {
+            tickedAt = ctx->expandedStates;
+            if (!ProgressTick(ctx, ctx->expandedStates, u.cost)) break;
+            if (store.engine == STORE_HASH) {
+                size_t used = fixedBytes + pqueueBytes(pq);
+                if (used + stateStoreBytes(&store) > budget) {
+                    overBudget = true;
+                    break;
+                }
+                store.byteLimit = budget - used;
+            }
+        }
+        size_t uId = DensePoseId(index, IDX_POS(u.y, u.x, u.mode, cols));
+        size_t uIdx = GET_IDX(uId, u.mask, maxMask);
+
+        // queue keys are g + h, the bound is recomputed rather than stored in every node
+        int g = u.cost;
+        if (useAStar) g -= ExactLowerBound(&heur, uId, u.mask);
+        if (g > getStateDist(&store, uIdx)) { counters.stalePops++; continue; }
+        ctx->expandedStates++;
+        if (u.mask == (maxMask - 1)) { // All targets visited
+            finalMinCost = g;
+            finalStateIdx = uIdx;
+            break;
+        }
+        for (int i = 0; i < 8; i++) {
+            int nextMode = ctx->moves[u.mode][i][0];
+            int dx = ctx->moves[u.mode][i][1];
+            int dy = ctx->moves[u.mode][i][2];
+            int fuel = ctx->moves[u.mode][i][3];
+            int nx = u.x + dx;
+            int ny = u.y + dy;
+
+            if (IsPoseFree(ctx, nx, ny, nextMode)) {
+                // every move out of a reachable pose lands on one
+                size_t vId = DensePoseId(index, IDX_POS(ny, nx, nextMode, cols));
+                int newCost = g + fuel;
+                int newMask = u.mask | (int)coverMask[vId];
+                int bound = useAStar ? ExactLowerBound(&heur, vId, newMask) : 0;
+                if (bound >= EXACT_H_INF) continue; // a missing target is out of reach from here
+
+                size_t vIdx = GET_IDX(vId, newMask, maxMask);
+                if (relaxState(&store, vIdx, newCost, ENCODE_PARENT(u.mode, i))) {
+                    pushPQueue(pq, (PQNode){nx, ny, nextMode, newMask, newCost + bound});
+                    counters.relaxations++;
+                }
+            }
+        }
+    }
+
+    // Reconstruct
+    if (finalMinCost != -1) {
+        ctx->totalFuelCost = finalMinCost;
+        SOLVER_LOG(ctx, "SUCCESS: Optimal path found! Total Fuel: %d\n", finalMinCost);
+
+        // the parent chain gives the move indices end first, one byte each until reversed
+        int moveCount = 0;
+        int moveCap = 256;
+        uint8_t *moves = (uint8_t*)malloc(moveCap);
+        size_t curr = finalStateIdx;
+        for (size_t prev; (prev = ExactPredecessor(ctx, &store, coverMask, curr, maxMask)) != SIZE_MAX; curr = prev) {
+            if (moveCount == moveCap) {
+                moveCap *= 2;
+                moves = (uint8_t*)realloc(moves, moveCap);
+            }
+            moves[moveCount++] = (uint8_t)PARENT_MOVE(getStateParent(&store, curr));
+        }
+
+        int mk;
+        State s = DecodeIndex(ctx, curr, &mk, maxMask);
+        PathTraceStart(&ctx->tspPath, (PathStep){s.x, s.y, s.mode});
+        for (int i = moveCount - 1; i >= 0; i--) PathTracePush(ctx, &ctx->tspPath, moves[i]);
+        free(moves);
+        ctx->engineUsed = TSP_EXACT;
+    } else if (SolveCancelled(ctx)) {
+        SOLVER_LOG(ctx, "Cancelled after %zu states.\n", ctx->expandedStates);
+    } else if (overBudget) {
+        SOLVER_LOG(ctx, "FAILURE: the search would outgrow the %zu MB budget after %zu states.\n", budget >> 20, ctx->expandedStates);
+    } else if (store.full) {
+        SOLVER_LOG(ctx, "FAILURE: out of memory growing the state store after %zu states.\n", ctx->expandedStates);
+    } else {
+        SOLVER_LOG(ctx, "FAILURE: Could not reach all active targets.\n");
+    }
+    SOLVER_LOG(ctx, "State store: %s, %zu MB\n", store.engine == STORE_DENSE ? "dense" : "hash", stateStoreBytes(&store) >> 20);
+    SOLVER_LOG(ctx, "Expanded %zu states (%s)\n", ctx->expandedStates, useAStar ? "A*" : "Dijkstra");
+    if (ctx->stats) {
+        addSearchCounters(&ctx->stats->exact, &counters);
+        StatsStop(ctx, STATS_EXACT_SEARCH, statsStart, poses * sizeof(uint32_t) + stateStoreBytes(&store) + pqueueBytes(pq));
+    }
+
+    FreeExactHeuristic(&heur);
+    free(coverMask);
+    freePQueue(pq);
+    freeStateStore(&store);
+    return finalMinCost != -1;
+}
+
+// Approx TSP (Christofides Algorithm)
+// anchor mode on (sx, sy): the first reachable one once MarkReachable has run, else the first free one
+int GetSimpleMode(const SolverContext *ctx, int sx, int sy) {
+    if(ctx->visited) {
+        for(int m=0; m<4; m++) if(ctx->visited[IDX_POS(sy, sx, m, ctx->cols)]) return m;
+    }
+    int startMode = 0;
+    if(!IsPoseFree(ctx, sx, sy, 0)) {
+        for(int m=0; m<4; m++) if(IsPoseFree(ctx, sx, sy, m)) { startMode=m; break; }
+    }
+    return startMode;
+}
+
+typedef struct {
+    const SolverContext *ctx;
+    const ActiveTarget *allNodes;
+    const State *anchors;       // search source of each row
+    int numRealNodes;
+    int *costMat;
+    int stride;
+    SearchScratch *scratch;     // one per worker
+    int *rows;                  // numRealNodes entries per worker
+} CostMatrixJob;
+
+static void CostMatrixRow(void *arg, int i, int worker) {
+    CostMatrixJob *job = (CostMatrixJob*)arg;
+    const ActiveTarget *node = &job->allNodes[i];
+    int *row = job->rows + (size_t)worker * job->numRealNodes;
+    SearchScratch *scratch = &job->scratch[worker];
+    if(SolveCancelled(job->ctx)) return;
+    if(!scratch->dist) InitSearchScratch(job->ctx, scratch);
+
+    OneToManyWithScratch(job->ctx, scratch, job->anchors[i], node + 1, job->numRealNodes - i - 1, row);
+    for(int j=i+1; j<job->numRealNodes; j++) {
+        int c = row[j - i - 1] < 0 ? LEG_COST_NONE : row[j - i - 1];
+        job->costMat[i*job->stride + j] = c;
+        job->costMat[j*job->stride + i] = c;
+    }
+    ProgressStep(job->ctx);
+}
+
+// costs from node i to every later node with one search per row, mirrored below the diagonal.
+// Rows are independent, so they are spread over the solver thread pool.
+static void BuildCostMatrix(SolverContext *ctx, const ActiveTarget *allNodes, const State *anchors, int numRealNodes, int *costMat, int stride) {
+    ThreadPool *pool = GetSolverPool(ctx);
+    int workers = threadPoolSize(pool);
+    CostMatrixJob job = {ctx, allNodes, anchors, numRealNodes, costMat, stride, NULL, NULL};
+    job.scratch = (SearchScratch*)calloc(workers, sizeof(SearchScratch));
+    job.rows = (int*)malloc((size_t)workers * numRealNodes * sizeof(int));
+
+    parallelFor(pool, numRealNodes, CostMatrixRow, &job);
+
+    for(int w=0; w<workers; w++) {
+        if(ctx->stats && job.scratch[w].dist) {
+            size_t cells = (size_t)ctx->rows * ctx->cols;
+            addSearchCounters(&ctx->stats->dijkstra, &job.scratch[w].counters);
+            ctx->stats->bytes[STATS_MATRIX] += cells * 5 * sizeof(int) + pqueueBytes(job.scratch[w].pq);
+        }
+        FreeSearchScratch(&job.scratch[w]);
+    }
+    free(job.scratch);
+    free(job.rows);
+}
+
+static void GetMST(int nodeCount, int *costMatrix, int *parentOut) {
+    int *key = (int*)malloc(nodeCount * sizeof(int));
+    bool *mstSet = (bool*)malloc(nodeCount * sizeof(bool));
+    for (int i = 0; i < nodeCount; i++) { key[i] = INT_MAX; mstSet[i] = false; }
+    key[0] = 0; parentOut[0] = -1;
+
+    for (int count = 0; count < nodeCount - 1; count++) {
+        int min = INT_MAX, u = -1;
+        for (int v = 0; v < nodeCount; v++) {
+            if (!mstSet[v] && key[v] < min) { min = key[v]; u = v; }
+        }
+        if (u == -1) break;
+        mstSet[u] = true;
+        for (int v = 0; v < nodeCount; v++) {
+            int weight = costMatrix[u * nodeCount + v];
+            if (weight && !mstSet[v] && weight < key[v]) {
+                parentOut[v] = u; key[v] = weight;
+            }
+        }
+    }
+    free(key); free(mstSet);
+}
+
+static void FindEulerTour(int nodeCount, int *adjMatrix, int *circuit, int *circuitSize) {
+    int *stack = (int*)malloc((size_t)nodeCount * nodeCount * sizeof(int));
+    int top = 0;
+    stack[top] = 0;
+    int pathIdx = 0;
+
+    int *tempAdj = (int*)malloc((size_t)nodeCount * nodeCount * sizeof(int));
+    memcpy(tempAdj, adjMatrix, (size_t)nodeCount * nodeCount * sizeof(int));
+
+    while(top >= 0) {
+        int curr_v = stack[top];
+        int neighbor = -1;
+        for(int i=0; i<nodeCount; i++) {
+            if(tempAdj[curr_v * nodeCount + i] > 0) { neighbor = i; break; }
+        }
+        if(neighbor != -1) {
+            tempAdj[curr_v * nodeCount + neighbor]--;
+            tempAdj[neighbor * nodeCount + curr_v]--;
+            stack[++top] = neighbor;
+        }
+        else {
+            circuit[pathIdx++] = stack[top--];
+        }
+    }
+    *circuitSize = pathIdx;
+    free(stack);
+    free(tempAdj);
+}
+
+// MST of the nodes plus the dummy, greedy matching of the odd vertices and an Euler tour
+// with repeats dropped. Fills visitOrder from node 0 and returns its length.
+int ChristofidesOrder(int *costMat, int nodeCount, int *visitOrder) {
+    int totalNodes = nodeCount + 1;
+    int dummy = totalNodes - 1;
+    costMat[0 * totalNodes + dummy] = 999999;
+    costMat[dummy * totalNodes + 0] = 999999;
+    for(int i=1; i<nodeCount; i++) {
+        costMat[i * totalNodes + dummy] = 0;
+        costMat[dummy * totalNodes + i] = 0;
+    }
+
+    int *mstParent = (int*)malloc(totalNodes * sizeof(int));
+    GetMST(totalNodes, costMat, mstParent);
+
+    int *multiGraph = (int*)calloc((size_t)totalNodes * totalNodes, sizeof(int));
+    int *degrees = (int*)calloc(totalNodes, sizeof(int));
+    for(int i=1; i<totalNodes; i++) {
+        int u = i; int v = mstParent[i];
+        if(v != -1) {
+            multiGraph[u*totalNodes + v]++;
+            multiGraph[v*totalNodes + u]++;
+            degrees[u]++;
+            degrees[v]++;
+        }
+    }
+
+    int *odds = (int*)malloc(totalNodes * sizeof(int));
+    int oddCount = 0;
+    for(int i=0; i<totalNodes; i++) if(degrees[i] % 2 != 0) odds[oddCount++] = i;
+
+    bool *matched = (bool*)calloc(totalNodes, sizeof(bool));
+    for(int i=0; i<oddCount; i++) {
+        int u = odds[i];
+        if(matched[u]) continue;
+        int minW = INT_MAX, bestV = -1;
+        for(int j=i+1; j<oddCount; j++) {
+            int v = odds[j];
+            if(!matched[v] && costMat[u*totalNodes + v] < minW) {
+                minW = costMat[u*totalNodes + v];
+                bestV = v;
+            }
+        }
+        if(bestV != -1) {
+            matched[u] = true;
+            matched[bestV] = true;
+            multiGraph[u*totalNodes + bestV]++;
+            multiGraph[bestV*totalNodes + u]++;
+        }
+    }
+
+    //  Euler tour
+    int *circuit = (int*)malloc(totalNodes * 2 * sizeof(int));
+    int circuitSize = 0;
+    FindEulerTour(totalNodes, multiGraph, circuit, &circuitSize);
+
+    // circuit is reversed
+
+    // extract TSP path (remove duplicates)
+    bool *visitedMap = (bool*)calloc(totalNodes, sizeof(bool));
+    int orderCount = 0;
+    for(int i=circuitSize-1; i>=0; i--) {
+        int node = circuit[i];
+        if(node == dummy) continue;
+        if(!visitedMap[node]) {
+            visitedMap[node] = true;
+            visitOrder[orderCount++] = node;
+        }
+    }
+
+    free(mstParent);
+    free(multiGraph);
+    free(degrees);
+    free(odds);
+    free(matched);
+    free(circuit);
+    free(visitedMap);
+    return orderCount;
+}
+
+static int StitchPath(SolverContext *ctx, LegScratch *scratch, int startX, int startY, int startMode, int targetX, int targetY) {
+    PathStep* tempPath = NULL;
+    int tempStepCount = 0;
+    int cost = BidirectionalLegWithScratch(ctx, scratch, (State){startX, startY, startMode}, targetX, targetY, &tempPath, &tempStepCount);
+
+    // stitch path to global trace
+    if(cost != -1 && !PathTraceAppend(ctx, &ctx->tspPath, tempPath, tempStepCount)) cost = -1;
+    free(tempPath);
+    return cost;
+}
+
+typedef struct {
+    SolverContext *ctx;
+    const ActiveTarget *allNodes;
+    int *objectiveOrder;
+} TourReportJob;
+
+// forwards a tour over allNodes to ctx->onTour as objective indices, without the start
+static void ReportApproxTour(void *arg, const int *order, int count, int cost) {
+    TourReportJob *job = (TourReportJob*)arg;
+    for(int i=1; i<count; i++) job->objectiveOrder[i - 1] = job->allNodes[order[i]].originalIdx;
+    job->ctx->onTour(job->ctx->tourUser, job->objectiveOrder, count - 1, cost);
+}
+
+bool SolveTSP_Approx(SolverContext *ctx) {
+    SOLVER_LOG(ctx, "\n--- Starting Approximate TSP ---\n");
+    double solveStart = SolverGetTime();
+    State start = ctx->start_state;
+    // allNodes[0] is the start, the reachable objectives follow
+    ActiveTarget *allNodes = (ActiveTarget*)malloc((ctx->objCount + 1) * sizeof(ActiveTarget));
+    int activeCount = CollectActiveTargets(ctx, allNodes + 1);
+    if(activeCount == 0) { free(allNodes); return false; }
+
+    int numRealNodes = activeCount + 1; // add start
+    int totalNodes = numRealNodes + 1; // add dummy
+    allNodes[0].x = start.x;
+    allNodes[0].y = start.y;
+    allNodes[0].originalIdx = -1;
+    int *costMat = (int*)calloc((size_t)totalNodes * totalNodes, sizeof(int));
+    // where the matrix searches start: the real start pose, then each target in its simple mode
+    State *anchors = (State*)malloc(numRealNodes * sizeof(State));
+    anchors[0] = start;
+    for(int i=1; i<numRealNodes; i++) anchors[i] = (State){allNodes[i].x, allNodes[i].y, GetSimpleMode(ctx, allNodes[i].x, allNodes[i].y)};
+
+    // with room for a tree per target the matrix comes from the leg cache, else from forward rows
+    ProgressPhase(ctx, PHASE_DISTANCES, numRealNodes);
+    double statsStart = StatsStart(ctx);
+    LegCache legCache;
+    bool useCache = LegCacheBytes(ctx, activeCount, threadPoolSize(GetSolverPool(ctx)), false) <= SolverMemoryBudget(ctx)
+                 && InitLegCache(ctx, &legCache, activeCount, false);
+    if(useCache) BuildLegCache(ctx, &legCache, allNodes, numRealNodes, anchors, costMat, totalNodes);
+    else BuildCostMatrix(ctx, allNodes, anchors, numRealNodes, costMat, totalNodes);
+    free(anchors);
+    StatsStop(ctx, STATS_MATRIX, statsStart, (size_t)totalNodes * totalNodes * sizeof(int));
+    if(SolveCancelled(ctx)) {
+        if(useCache) FreeLegCache(&legCache);
+        free(costMat);
+        free(allNodes);
+        return false;
+    }
+    ProgressPhase(ctx, PHASE_TOUR, 0);
+    statsStart = StatsStart(ctx);
+    int *visitOrder = (int*)malloc(totalNodes * sizeof(int));
+    int orderCount = ChristofidesOrder(costMat, numRealNodes, visitOrder);
+
+    // anytime part: publish the initial order, then improve it until the budget runs out
+    TourReportJob report = {ctx, allNodes, (int*)malloc(totalNodes * sizeof(int))};
+    // multigraph, Euler stack and its adjacency copy, the node arrays
+    StatsStop(ctx, STATS_TOUR, statsStart, (size_t)totalNodes * totalNodes * 3 * sizeof(int) + (size_t)totalNodes * 7 * sizeof(int));
+    int before = 0;
+    for(int i=1; i<orderCount; i++) before += costMat[visitOrder[i-1] * totalNodes + visitOrder[i]];
+    if(ctx->onTour) ReportApproxTour(&report, visitOrder, orderCount, before);
+    ProgressTick(ctx, 0, before);
+    if(ctx->approxTimeBudget > 0) {
+        statsStart = StatsStart(ctx);
+        int after = ImproveTour(ctx, costMat, totalNodes, visitOrder, orderCount, solveStart + ctx->approxTimeBudget,
+                                ctx->onTour ? ReportApproxTour : NULL, &report);
+        StatsStop(ctx, STATS_LOCAL_SEARCH, statsStart, (size_t)orderCount * 2 * sizeof(int));
+        SOLVER_LOG(ctx, "Local search: matrix cost %d -> %d\n", before, after);
+    }
+    free(report.objectiveOrder);
+
+    // stitch physical path
+    PathTraceStart(&ctx->tspPath, (PathStep){start.x, start.y, start.mode}); // legs are appended by WalkLeg or StitchPath
+    ctx->totalFuelCost = 0;
+
+    ProgressPhase(ctx, PHASE_PATH, orderCount - 1);
+    statsStart = StatsStart(ctx);
+    // leg search buffers, only set up once a leg misses the cache
+    LegScratch legScratch = {0};
+    int walked = 0;
+    bool cancelled = false, stitched = true;
+    for(int i=1; i<orderCount && stitched && !(cancelled = !ProgressStep(ctx)); i++) {
+        int targetNodeIdx = visitOrder[i];
+        int tX = allNodes[targetNodeIdx].x;
+        int tY = allNodes[targetNodeIdx].y;
+        PathStep cur = ctx->tspPath.last;
+        int legCost = -1;
+        if(useCache) legCost = WalkLeg(ctx, &legCache, targetNodeIdx - 1, (State){cur.x, cur.y, cur.m}, &ctx->tspPath);
+        if(legCost != -1) walked++;
+        else {
+            if(!legScratch.dist) InitLegScratch(ctx, &legScratch);
+            legCost = StitchPath(ctx, &legScratch, cur.x, cur.y, cur.m, tX, tY);
+        }
+        if(legCost != -1) ctx->totalFuelCost += legCost;
+        else stitched = false;
+    }
+    cancelled = cancelled || SolveCancelled(ctx);
+    if(!stitched && !cancelled) SOLVER_LOG(ctx, "FAILURE: no leg from (%d, %d) on, the tour is incomplete.\n", ctx->tspPath.last.x, ctx->tspPath.last.y);
+    size_t legBytes = 0;
+    if(legScratch.dist) {
+        legBytes = (size_t)ctx->rows * ctx->cols * 4 * 2 * (sizeof(int) + 1) + legScratch.touchedCap * sizeof(size_t)
+                 + pqueueBytes(legScratch.pq[0]) + pqueueBytes(legScratch.pq[1]);
+    }
+    FreeLegScratch(&legScratch);
+    if(useCache) {
+        SOLVER_LOG(ctx, "Leg cache: %d of %d legs walked\n", walked, orderCount - 1);
+        FreeLegCache(&legCache);
+    }
+    StatsStop(ctx, STATS_STITCH, statsStart, legBytes + PathTraceBytes(&ctx->tspPath));
+
+    bool failed = cancelled || !stitched;
+    if(failed) {
+        PathTraceFree(&ctx->tspPath);
+        ctx->totalFuelCost = 0;
+    } else {
+        ctx->engineUsed = TSP_APPROX;
+        SOLVER_LOG(ctx, "Approximation Complete. Total Steps: %d, Cost: %d\n", ctx->tspPath.count, ctx->totalFuelCost);
+    }
+
+    free(costMat);
+    free(visitOrder);
+    free(allNodes);
+    return !failed;
+}
+
+const char* TSPEngineName(TSPEngine engine) {
+    switch (engine) {
+        case TSP_EXACT: return "exact";
+        case TSP_HELD_KARP: return "held-karp";
+        case TSP_APPROX: return "approx";
+        default: return "auto";
+    }
+}
+
+// runs ctx->tspEngine. TSP_AUTO runs the engine PlanSolve picks and falls back to the
+// approximation when an exact engine gives up.
+bool SolveTSP(SolverContext *ctx) {
+    if (ctx->reachableCount <= 0) {
+        SOLVER_LOG(ctx, "No reachable objectives to solve.\n");
+        return false;
+    }
+    switch (ctx->tspEngine) {
+        case TSP_EXACT: return SolveTSP_Exact(ctx);
+        case TSP_HELD_KARP: return SolveTSP_HeldKarp(ctx);
+        case TSP_APPROX: return SolveTSP_Approx(ctx);
+        default: break;
+    }
+
+    PlanSolve(ctx, &ctx->plan);
+    LogSolvePlan(ctx, &ctx->plan);
+    if (ctx->plan.engine == TSP_HELD_KARP && SolveTSP_HeldKarp(ctx)) return true;
+    if (ctx->plan.engine == TSP_EXACT) {
+        StoreEngine store = ctx->stateStore;
+        ctx->stateStore = ctx->plan.store;
+        bool solved = SolveTSP_Exact(ctx);
+        ctx->stateStore = store;
+        if (solved) return true;
+    }
+    if (SolveCancelled(ctx)) return false;
+    if (ctx->plan.engine != TSP_APPROX) SOLVER_LOG(ctx, "Falling back to the approximation.\n");
+    return SolveTSP_Approx(ctx);
+}
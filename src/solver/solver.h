@@ -0,0 +1,269 @@
+#ifndef PATHFINDER_SOLVER_H
+#define PATHFINDER_SOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pqueue.h"
+#include "statestore.h"
+#include "stats.h"
+#include "threadpool.h"
+
+// constants
+#define EXACT_TARGET_LIMIT 15
+#define HELD_KARP_TARGET_LIMIT 20
+#define HELD_KARP_MAX_BYTES ((size_t)1 << 30)     // cap on the Held-Karp DP table
+#define HELD_KARP_MAX_SECONDS 60.0                // Held-Karp refuses maps its estimate puts above this
+
+// coordinate index
+// exact solver state: dense pose id (see PoseIndex) and target mask
+#define GET_IDX(id, mk, maxMask) ((size_t)(id) * (maxMask) + (mk))
+#define IDX_POS(r, c, m, cols) \
+    ((size_t)(r) * (cols) * 4 + (size_t)(c) * 4 + (m))
+// one byte predecessor: the previous mode and the index of the move taken from it,
+// the previous pose is the current one minus that move's offset
+#define ENCODE_PARENT(prevMode, move) ((uint8_t)(((prevMode) << 3) | (move)))
+#define PARENT_MODE(code) ((code) >> 3)
+#define PARENT_MOVE(code) ((code) & 7)
+// cell value of the row-major maze grid
+#define MAZE_AT(ctx, r, c) ((ctx)->maze[(size_t)(r) * (ctx)->cols + (c)])
+
+// [mode][dir][0:new_mode, 1:dx, 2:dy, 3:fuel]
+extern const int Mode_Movement_Fuel[4][8][4];
+
+// structures
+typedef struct {
+    int x, y, mode;
+} State;
+
+// step for playback
+typedef struct { int x, y, m; } PathStep;
+
+// Solution path as move indices: step k + 1 is step k moved by moves[step k mode][code k].
+// 21 codes of 3 bits share a word, every PATH_MARK_STEPS-th pose is kept for seeking.
+#define PATH_CODES_PER_WORD 21
+#define PATH_MARK_WORDS 64
+#define PATH_MARK_STEPS (PATH_CODES_PER_WORD * PATH_MARK_WORDS)
+typedef struct {
+    uint64_t *codes;
+    PathStep *marks;        // marks[j] is step j * PATH_MARK_STEPS
+    int count;              // steps, the start included, 0 while empty
+    int codeCap, markCap;   // words and marks allocated
+    PathStep last;
+} PathTrace;
+
+// decodes a PathTrace forward from any step, a mark at most PATH_MARK_STEPS moves back
+typedef struct {
+    const PathTrace *trace;
+    const int (*moves)[8][4];
+    int index;
+    PathStep step;
+} PathCursor;
+
+typedef struct { int x, y; bool reachable; } Objective;
+
+typedef struct {
+    int x, y;
+    int originalIdx;
+} ActiveTarget;
+
+// dense numbering of the poses reachable from start_state, built by CheckAccessibility.
+// Ids follow IDX_POS order: the id of a pose is rank[idx >> 6] plus the reachable poses
+// before it in bits[idx >> 6], pose[id] maps back.
+typedef struct {
+    size_t count;       // reachable poses
+    uint64_t *bits;     // one bit per IDX_POS pose
+    size_t *rank;       // reachable poses before each 64-pose word
+    size_t *pose;       // [id] IDX_POS of the reachable pose, NULL after edits until ListIndexPoses
+} PoseIndex;
+
+#define POSE_NONE SIZE_MAX
+
+typedef enum {
+    TSP_AUTO = 0,
+    TSP_EXACT,          // bitmask Dijkstra over (pose, mask)
+    TSP_HELD_KARP,      // pose distance table + Held-Karp DP
+    TSP_APPROX          // Christofides style tour
+} TSPEngine;
+
+// called with each better visiting order the approximate solver finds: objective indices
+// in visiting order and the tour cost over the distance matrix, starting with the initial tour
+typedef void (*TourReport)(void *user, const int *order, int count, int cost);
+
+typedef enum {
+    PHASE_IDLE = 0,
+    PHASE_ACCESSIBILITY,    // reachability BFS
+    PHASE_DISTANCES,        // heuristic tables, pose or target distance matrix
+    PHASE_SEARCH,           // exact state search or Held-Karp DP
+    PHASE_TOUR,             // Christofides tour and local search
+    PHASE_PATH,             // stitching the physical path
+    PHASE_DONE
+} SolverPhase;
+
+// snapshot of a running solve, see PollSolveTask
+typedef struct {
+    SolverPhase phase;
+    size_t states;      // states settled by the current search
+    int bound;          // exact: lower bound on the optimum, approx: best tour cost, -1 before either is known
+    int done, total;    // units of the phase finished, total is 0 when the phase cannot tell
+} SolverProgress;
+
+// engine choice of SolveTSP under TSP_AUTO, see PlanSolve
+typedef struct {
+    TSPEngine engine;
+    StoreEngine store;          // state store when engine is TSP_EXACT
+    size_t budget;              // bytes the choice had to fit
+    int targets;
+    size_t reachablePoses;
+    size_t bytes[TSP_APPROX + 1];       // estimated peak bytes, indexed by TSPEngine
+    double seconds[TSP_APPROX + 1];     // rough time, only good for ranking the engines
+} SolvePlan;
+
+typedef struct SolverMonitor SolverMonitor;
+typedef struct SolveTask SolveTask;
+typedef struct Replanner Replanner;
+
+// all state of one solve, so several mazes can be solved side by side
+typedef struct {
+    // maze
+    uint8_t *maze;          // rows*cols cell values, row-major (see MAZE_AT)
+    int rows, cols;
+    State start_state;
+    uint64_t *poseFree;     // one bit per IDX_POS pose, set when the car body fits there
+
+    // accessibility check
+    Objective *objectives;
+    int objCount;
+    bool *visited;          // rows*cols*4, indexed by IDX_POS
+    int reachableCount;
+    PoseIndex poseIndex;    // reachable poses, patched by SetMazeCell when the pose table changes
+
+    // TSP
+    PathTrace tspPath;          // tspPath.count steps from the start pose
+    int totalFuelCost;
+    TSPEngine engineUsed;
+    SolvePlan plan;             // last TSP_AUTO decision
+    size_t expandedStates;      // states the last exact search settled
+
+    // search settings
+    const int (*moves)[8][4];   // move/cost table, Mode_Movement_Fuel unless replaced
+    PQEngine queueEngine;       // PQ_AUTO uses buckets when every fuel cost is small
+    StoreEngine stateStore;     // exact solver state storage, STORE_AUTO picks by search and table size
+    bool exactHeuristic;        // exact solver runs A* with the target lower bound instead of Dijkstra
+    TSPEngine tspEngine;        // engine SolveTSP runs, TSP_AUTO picks by target count
+    int workerCount;            // threads for parallel phases, 0 uses one per CPU
+    size_t memoryBudget;        // bytes a solve may use, 0 allows three quarters of the available RAM
+    double approxTimeBudget;    // seconds from the start of an approximate solve, spent on tour local search
+    TourReport onTour;          // optional, sees every improved approximate tour
+    void *tourUser;
+    ThreadPool *pool;           // created on first use
+    SolverMonitor *monitor;     // set while a SolveTask runs, receives progress and carries the cancel flag
+    SolverStats *stats;         // optional, counters and phase timers are only kept while this is set
+    Replanner *replanner;       // set between StartReplanner and StopReplanner
+
+    // print progress messages to stdout
+    bool verbose;
+} SolverContext;
+
+// lifetime
+void SolverInit(SolverContext *ctx);
+void SolverFree(SolverContext *ctx);
+
+// maze
+// text or binary maze, the format is detected from the file contents
+bool LoadMaze(SolverContext *ctx, const char *filename);
+bool LoadMazeFromMemory(SolverContext *ctx, const char *data, size_t size);
+bool SaveMazeBinary(const SolverContext *ctx, const char *filename);
+void GetCarBody(int mode, int body[6][2]);
+int CheckCarCollision(const SolverContext *ctx, int x, int y, int mode);
+void BuildPoseTable(SolverContext *ctx);
+bool PoseCoversCell(int x, int y, int mode, int cellX, int cellY);
+void BuildCoverMasks(const SolverContext *ctx, const ActiveTarget *targets, int count, uint32_t *coverMask);
+
+// table lookup equivalent of CheckCarCollision, valid after LoadMaze
+static inline bool IsPoseFree(const SolverContext *ctx, int x, int y, int mode) {
+    if ((unsigned)x >= (unsigned)ctx->cols || (unsigned)y >= (unsigned)ctx->rows) return false;
+    size_t idx = IDX_POS(y, x, mode, ctx->cols);
+    return (ctx->poseFree[idx >> 6] >> (idx & 63)) & 1;
+}
+
+// the builtin is a library call unless the target has a popcount instruction
+static inline int PopCount64(uint64_t v) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__POPCNT__) || defined(__ARM_NEON))
+    return __builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// dense id of IDX_POS pose idx, POSE_NONE when it is not reachable
+static inline size_t DensePoseId(const PoseIndex *index, size_t idx) {
+    uint64_t word = index->bits[idx >> 6];
+    uint64_t bit = (uint64_t)1 << (idx & 63);
+    if (!(word & bit)) return POSE_NONE;
+    return index->rank[idx >> 6] + (size_t)PopCount64(word & (bit - 1));
+}
+
+// path trace (pathtrace.c), the push functions return false when out of memory or
+// when a step is not one move on from the last
+bool PathTraceStart(PathTrace *trace, PathStep start);      // keeps the buffers
+bool PathTracePush(const SolverContext *ctx, PathTrace *trace, int move);
+bool PathTraceAppend(const SolverContext *ctx, PathTrace *trace, const PathStep *steps, int count);
+void PathTraceFree(PathTrace *trace);
+size_t PathTraceBytes(const PathTrace *trace);
+PathStep PathTraceAt(const SolverContext *ctx, const PathTrace *trace, int index);
+// for (bool more = PathCursorSeek(&c, ctx, trace, 0); more; more = PathCursorNext(&c))
+// visits every step; Next leaves the cursor on the last step once it returns false
+bool PathCursorSeek(PathCursor *cursor, const SolverContext *ctx, const PathTrace *trace, int index);
+bool PathCursorNext(PathCursor *cursor);
+
+// searches
+int Dijkstra(const SolverContext *ctx, int startX, int startY, int startMode, int targetX, int targetY, PathStep **outPath, int *outStepCount);
+int DijkstraToPose(const SolverContext *ctx, int startX, int startY, int startMode, int targetX, int targetY, int targetMode, PathStep **outPath, int *outStepCount);
+// same result as Dijkstra, searching from both ends
+int DijkstraBidirectional(const SolverContext *ctx, int startX, int startY, int startMode, int targetX, int targetY, PathStep **outPath, int *outStepCount);
+void DijkstraAll(const SolverContext *ctx, int startX, int startY, int startMode, int *dist);
+void DijkstraOneToMany(const SolverContext *ctx, int startX, int startY, int startMode, const ActiveTarget *targets, int count, int *outCosts);
+void CheckAccessibility(SolverContext *ctx);
+
+// TSP, all return false when no tour was produced
+bool SolveTSP_Exact(SolverContext *ctx);
+bool SolveTSP_HeldKarp(SolverContext *ctx);
+bool SolveTSP_Approx(SolverContext *ctx);
+bool SolveTSP(SolverContext *ctx);
+// estimates every engine for the checked maze and picks one, as SolveTSP does under TSP_AUTO
+void PlanSolve(const SolverContext *ctx, SolvePlan *plan);
+size_t GetAvailableMemory(void);
+
+// background solve: CheckAccessibility then SolveTSP on a worker thread. The context
+// belongs to the task until FinishSolveTask, which waits for the thread, frees the task
+// and returns the SolveTSP result. A cancelled solve frees its buffers and returns false.
+// Builds with SOLVER_NO_THREADS finish the solve inside StartSolveTask.
+SolveTask* StartSolveTask(SolverContext *ctx);
+bool PollSolveTask(SolveTask *task, SolverProgress *progress);     // true once the solve has stopped
+void CancelSolveTask(SolveTask *task);
+bool FinishSolveTask(SolveTask *task, bool *cancelled);
+const char* SolverPhaseName(SolverPhase phase);
+const char* TSPEngineName(TSPEngine engine);
+
+// Maze edits and incremental re-planning. SetMazeCell writes 0 (wall), 1 (free) or 3
+// (objective) and keeps the pose table and the objective list in step; the car cells
+// cannot be edited. Without a replanner CheckAccessibility and SolveTSP have to run again.
+bool SetMazeCell(SolverContext *ctx, int x, int y, int value);
+// Solves the loaded maze in place of CheckAccessibility and SolveTSP, keeping a complete
+// reverse tree with distances per objective. Like CheckAccessibility it clears the
+// objectives the car cannot stand on from the maze.
+bool StartReplanner(SolverContext *ctx);
+// repairs the trees for the edits since the last plan, then re-plans tour and path on
+// them. Objectives the edits cut off are cleared; false when no complete tour is left.
+bool Replan(SolverContext *ctx);
+void StopReplanner(SolverContext *ctx);
+
+// wall clock in seconds
+double SolverGetTime(void);
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef PATHFINDER_SOLVER_INTERNAL_H
+#define PATHFINDER_SOLVER_INTERNAL_H
+
+// helpers shared by the solver translation units, not part of the public API
+#include <limits.h>
+#include <stdio.h>
+
+#include "solver.h"
+
+#define SOLVER_LOG(ctx, ...) do { if ((ctx)->verbose) printf(__VA_ARGS__); } while (0)
+
+// search loops report every PROGRESS_INTERVAL settled states (power of two)
+#define PROGRESS_INTERVAL 4096
+
+// progress.c, no-ops without ctx->monitor. Tick and Step return false once the solve
+// is cancelled, the caller then unwinds and frees what it holds.
+void ProgressPhase(const SolverContext *ctx, SolverPhase phase, int total);
+bool ProgressTick(const SolverContext *ctx, size_t states, int bound);
+bool ProgressStep(const SolverContext *ctx);
+bool SolveCancelled(const SolverContext *ctx);
+
+// phase timers and byte counts for ctx->stats, the clock is only read when stats are on
+static inline double StatsStart(const SolverContext *ctx) {
+    return ctx->stats ? SolverGetTime() : 0;
+}
+static inline void StatsStop(const SolverContext *ctx, StatsPhase phase, double start, size_t bytes) {
+    if (!ctx->stats) return;
+    ctx->stats->seconds[phase] += SolverGetTime() - start;
+    ctx->stats->bytes[phase] += bytes;
+}
+static inline SearchCounters* DijkstraCounters(const SolverContext *ctx) {
+    return ctx->stats ? &ctx->stats->dijkstra : NULL;
+}
+
+// planner.c: the memory a solve may use (ctx->memoryBudget bounded by the free RAM)
+size_t SolverMemoryBudget(const SolverContext *ctx);
+void LogSolvePlan(const SolverContext *ctx, const SolvePlan *plan);
+// Held-Karp peak bytes and rough seconds for k targets, coverPoses table poses (the start
+// included) and reachable poses. PlanSolve and SolveTSP_HeldKarp share them.
+double HeldKarpBytes(const SolverContext *ctx, int k, size_t coverPoses, size_t reachable);
+double HeldKarpSeconds(int k, size_t coverPoses, size_t reachable);
+
+void CollectObjectives(SolverContext *ctx);
+// solver.c: fills visited and poseIndex from the start pose and marks the objectives the
+// car can stand on in some mode, the rule every engine and the replanner share. False
+// when out of memory or cancelled, with nothing marked reachable.
+bool MarkReachable(SolverContext *ctx);
+void MarkReachableObjectives(SolverContext *ctx);
+// reach.c: the poses reachable from start as (mode, row) bitsets, bit c of word w of
+// reach[(mode * rows + row) * words] is column w * 64 + c with words = (cols + 63) / 64.
+// Move dx offsets must stay below 64. Returns false when cancelled or out of memory.
+bool ReachablePoseBits(const SolverContext *ctx, State start, uint64_t *reach);
+// the same poses as one bit per IDX_POS, bits holds (rows*cols*4 + 63) / 64 words
+void ReachToPoseBits(const SolverContext *ctx, const uint64_t *reach, uint64_t *bits);
+// ctx->poseIndex over the IDX_POS bitset bits, which it takes over, and searches over its
+// dense ids. Searches from a reachable pose never leave the reachable poses, so their
+// arrays need count entries.
+void BuildPoseIndex(SolverContext *ctx, uint64_t *bits);
+void FreePoseIndex(PoseIndex *index);
+// flips the IDX_POS poses in toggled (one may repeat) in bits and rank and drops pose[].
+// ListIndexPoses lists it again for the engines that map ids back, false when out of memory.
+void TogglePoseIndex(SolverContext *ctx, const size_t *toggled, size_t count);
+bool ListIndexPoses(SolverContext *ctx);
+// reach.c: brings visited, the index and the objective flags up to date after the poses
+// in flipped changed legality. False when the move table has a move that cannot be undone
+// or memory ran out, which leaves them to MarkReachable.
+bool UpdateReachable(SolverContext *ctx, const size_t *flipped, int flipCount);
+void BuildDenseCoverMasks(const SolverContext *ctx, const ActiveTarget *targets, int count, uint32_t *coverMask);
+// plain searches pay a rank lookup per relaxation on dense ids, which only beats the
+// full arrays when at most 1/DENSE_SEARCH_RATIO of the poses is reachable
+#define DENSE_SEARCH_RATIO 4
+// the index for a search from start, NULL when it should run on IDX_POS slots
+const PoseIndex *SearchPoseIndex(const SolverContext *ctx, State start);
+// dist holds dense->count entries, or rows*cols*4 when dense is NULL
+void DijkstraAllSlots(const SolverContext *ctx, State start, const PoseIndex *dense, int *dist);
+int CollectActiveTargets(const SolverContext *ctx, ActiveTarget *activeTargets);
+ThreadPool* GetSolverPool(SolverContext *ctx);
+PQueue* createSearchQueue(const SolverContext *ctx);
+
+// per-thread buffers so repeated searches neither allocate nor share memory
+typedef struct {
+    int *dist;          // rows*cols*4
+    int *cellTarget;    // rows*cols, -1 outside of a one-to-many search
+    PQueue *pq;
+    SearchCounters counters;    // searches run on this scratch, merged by the owner
+} SearchScratch;
+
+void InitSearchScratch(const SolverContext *ctx, SearchScratch *scratch);
+void FreeSearchScratch(SearchScratch *scratch);
+void OneToManyWithScratch(const SolverContext *ctx, SearchScratch *scratch, State start, const ActiveTarget *targets, int count, int *outCosts);
+
+// buffers for bidirectional leg searches, side 0 is the forward search and side 1 the
+// backward one. dist stays INT_MAX between legs, only the touched poses are reset.
+#define LEG_SLOT(idx, side) ((idx) * 2 + (side))
+typedef struct {
+    int *dist;          // [LEG_SLOT(pose, side)], both sides of a pose share a cache line
+    uint8_t *code;      // forward: ENCODE_PARENT, backward: index of the move leading on
+    size_t *touched;
+    size_t touchedCount, touchedCap;
+    PQueue *pq[2];
+    uint8_t reverse[4][32];     // ENCODE_PARENT codes of the moves ending in each mode
+    int reverseCount[4];
+} LegScratch;
+
+void InitLegScratch(const SolverContext *ctx, LegScratch *scratch);
+void FreeLegScratch(LegScratch *scratch);
+int BidirectionalLegWithScratch(const SolverContext *ctx, LegScratch *scratch, State start, int targetX, int targetY, PathStep **outPath, int *outStepCount);
+
+// legcache.c: a reverse shortest-path tree per target, so approx legs are walks instead
+// of searches. The same searches fill the cost matrix from the node anchors. With
+// keepDist the trees are complete and keep their distances for RepairLegTrees.
+typedef struct {
+    int count;                  // trees
+    size_t poseCount;
+    uint8_t *next;              // [tree * poseCount + pose] index of the move leading on, PARENT_NONE on covering poses
+    int *dist;                  // [tree * poseCount + pose] fuel to the target, NULL unless keepDist
+    uint8_t reverse[4][32];     // ENCODE_PARENT codes of the moves ending in each mode
+    int reverseCount[4];
+} LegCache;
+
+size_t LegCacheBytes(const SolverContext *ctx, int targetCount, int workers, bool keepDist);
+bool InitLegCache(const SolverContext *ctx, LegCache *cache, int targetCount, bool keepDist);
+void FreeLegCache(LegCache *cache);
+void BuildLegCache(SolverContext *ctx, LegCache *cache, const ActiveTarget *nodes, int nodeCount, const State *anchors, int *costMat, int stride);
+int WalkLeg(const SolverContext *ctx, const LegCache *cache, int t, State from, PathTrace *path);
+// keepDist caches only
+int AddLegTree(SolverContext *ctx, LegCache *cache, int targetX, int targetY);
+void RemoveLegTree(LegCache *cache, int t);
+void RepairLegTrees(SolverContext *ctx, LegCache *cache, const ActiveTarget *targets, const size_t *changed, int changedCount);
+int LegTreeDist(const SolverContext *ctx, const LegCache *cache, int t, State from);
+
+// solver.c: approx building blocks. costMat has nodeCount + 1 rows, the last one is a
+// dummy ChristofidesOrder fills in so the tour may end anywhere; node 0 is the start.
+int GetSimpleMode(const SolverContext *ctx, int sx, int sy);
+// matrix cost of a leg no search found: dearer than any real leg, so tours route around
+// it, yet a few of them still sum within an int
+#define LEG_COST_NONE (INT_MAX / 64)
+int ChristofidesOrder(int *costMat, int nodeCount, int *visitOrder);
+
+// tour.c: 2-opt / Or-opt with double-bridge kicks on an open path starting at order[0],
+// until the deadline (SolverGetTime) or a cancel, returns the best cost left in order
+int ImproveTour(const SolverContext *ctx, const int *cost, int stride, int *order, int count, double deadline, TourReport report, void *user);
+
+#endif
@@ -0,0 +1,66 @@
+#include "statestore.h"
+#include <stdlib.h>
+#include <string.h>
+
+static StoreSlot* allocSlots(size_t capacity) {
+    StoreSlot *slots = (StoreSlot*)malloc(capacity * sizeof(StoreSlot));
+    if (slots) for (size_t i = 0; i < capacity; i++) slots[i].key = STORE_EMPTY_KEY;
+    return slots;
+}
+
+bool initStateStore(StateStore *store, StoreEngine engine, size_t stateCount) {
+    memset(store, 0, sizeof(*store));
+    store->stateCount = stateCount;
+    store->byteLimit = SIZE_MAX;
+    size_t denseBytes = stateCount * (sizeof(int) + sizeof(uint8_t));
+    if (engine == STORE_AUTO) engine = (denseBytes <= DENSE_STORE_MAX_BYTES) ? STORE_DENSE : STORE_HASH;
+
+    if (engine == STORE_DENSE) {
+        store->dist = (int*)malloc(stateCount * sizeof(int));
+        store->parent = (uint8_t*)malloc(stateCount * sizeof(uint8_t));
+        if (store->dist && store->parent) {
+            store->engine = STORE_DENSE;
+            for (size_t i = 0; i < stateCount; i++) store->dist[i] = INT_MAX;
+            memset(store->parent, PARENT_NONE, stateCount);
+            return true;
+        }
+        free(store->dist);
+        free(store->parent);
+        store->dist = NULL;
+        store->parent = NULL;
+    }
+
+    store->engine = STORE_HASH;
+    store->capacity = INIT_STORE_CAPACITY;
+    store->slots = allocSlots(store->capacity);
+    return store->slots != NULL;
+}
+
+void freeStateStore(StateStore *store) {
+    free(store->dist);
+    free(store->parent);
+    free(store->slots);
+    memset(store, 0, sizeof(*store));
+}
+
+// doubles the table and reinserts every live slot
+bool growStateStore(StateStore *store) {
+    StoreSlot *old = store->slots;
+    size_t oldCapacity = store->capacity;
+    if (oldCapacity * sizeof(StoreSlot) * 3 > store->byteLimit) return false;
+    StoreSlot *slots = allocSlots(oldCapacity * 2);
+    if (!slots) return false;
+    store->slots = slots;
+    store->capacity = oldCapacity * 2;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (old[i].key == STORE_EMPTY_KEY) continue;
+        *findStateSlot(store, old[i].key) = old[i];
+    }
+    free(old);
+    return true;
+}
+
+size_t stateStoreBytes(const StateStore *store) {
+    if (store->engine == STORE_DENSE) return store->stateCount * (sizeof(int) + sizeof(uint8_t));
+    return store->capacity * sizeof(StoreSlot);
+}
@@ -0,0 +1,106 @@
+#ifndef PATHFINDER_STATESTORE_H
+#define PATHFINDER_STATESTORE_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// dense arrays above this size make STORE_AUTO pick the hash map
+#define DENSE_STORE_MAX_BYTES ((size_t)512 << 20)
+#define INIT_STORE_CAPACITY (1 << 16)
+
+typedef enum {
+    STORE_AUTO = 0,
+    STORE_DENSE,    // dist/parent arrays over every state index
+    STORE_HASH      // open addressing, memory follows the states discovered
+} StoreEngine;
+
+typedef struct {
+    uint64_t key;   // state index, STORE_EMPTY_KEY when the slot is free
+    int dist;
+    uint8_t parent;
+} StoreSlot;
+
+#define STORE_EMPTY_KEY UINT64_MAX
+
+// parent byte of a state that has none (the search start, or not seen yet)
+#define PARENT_NONE 0xFF
+
+// dist/parent per search state, unseen states read as INT_MAX / PARENT_NONE.
+// The parent is the one byte move code the solver stores (see ENCODE_PARENT).
+typedef struct {
+    StoreEngine engine;
+    size_t stateCount;
+    // STORE_DENSE
+    int *dist;
+    uint8_t *parent;
+    // STORE_HASH, linear probing over a power of two table
+    StoreSlot *slots;
+    size_t capacity;
+    size_t count;
+    size_t byteLimit;   // a growth may not hold more than this, old and doubled table together
+    bool full;          // a growth failed, the search has to stop: a state was dropped
+} StateStore;
+
+// engine is resolved here, STORE_AUTO and failed dense allocations fall back to the hash map
+bool initStateStore(StateStore *store, StoreEngine engine, size_t stateCount);
+void freeStateStore(StateStore *store);
+// doubles the hash table, false leaves the old table as it was. That happens when the
+// allocation fails or when the old and the doubled table would exceed byteLimit.
+bool growStateStore(StateStore *store);
+size_t stateStoreBytes(const StateStore *store);
+
+static inline size_t hashState(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+static inline StoreSlot* findStateSlot(const StateStore *store, uint64_t key) {
+    size_t mask = store->capacity - 1;
+    size_t i = hashState(key) & mask;
+    while (store->slots[i].key != key && store->slots[i].key != STORE_EMPTY_KEY) i = (i + 1) & mask;
+    return &store->slots[i];
+}
+
+static inline int getStateDist(const StateStore *store, size_t idx) {
+    if (store->engine == STORE_DENSE) return store->dist[idx];
+    StoreSlot *slot = findStateSlot(store, idx);
+    return slot->key == STORE_EMPTY_KEY ? INT_MAX : slot->dist;
+}
+static inline uint8_t getStateParent(const StateStore *store, size_t idx) {
+    if (store->engine == STORE_DENSE) return store->parent[idx];
+    StoreSlot *slot = findStateSlot(store, idx);
+    return slot->key == STORE_EMPTY_KEY ? PARENT_NONE : slot->parent;
+}
+// stores dist/parent when dist beats the known one, returns whether it did.
+// A new state that needs a table growth which fails is dropped and sets full.
+static inline bool relaxState(StateStore *store, size_t idx, int dist, uint8_t parent) {
+    if (store->engine == STORE_DENSE) {
+        if (dist >= store->dist[idx]) return false;
+        store->dist[idx] = dist;
+        store->parent[idx] = parent;
+        return true;
+    }
+    StoreSlot *slot = findStateSlot(store, idx);
+    if (slot->key == STORE_EMPTY_KEY) {
+        // keep the load factor at or below 1/2
+        if ((store->count + 1) * 2 > store->capacity) {
+            if (!growStateStore(store)) {
+                store->full = true;
+                return false;
+            }
+            slot = findStateSlot(store, idx);
+        }
+        slot->key = idx;
+        store->count++;
+    } else if (dist >= slot->dist) {
+        return false;
+    }
+    slot->dist = dist;
+    slot->parent = parent;
+    return true;
+}
+
+#endif
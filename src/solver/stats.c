@@ -0,0 +1,40 @@
+#include "stats.h"
+#include <string.h>
+
+void resetSolverStats(SolverStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+void addSearchCounters(SearchCounters *into, const SearchCounters *from) {
+    into->searches += from->searches;
+    into->pops += from->pops;
+    into->stalePops += from->stalePops;
+    into->relaxations += from->relaxations;
+    if (from->queuePeak > into->queuePeak) into->queuePeak = from->queuePeak;
+}
+
+const char* statsPhaseName(StatsPhase phase) {
+    static const char *names[STATS_PHASE_COUNT] = {
+        "load", "accessibility", "heuristic", "exact_search", "pose_table",
+        "held_karp_dp", "matrix", "tour", "local_search", "stitch", "replan"
+    };
+    return (unsigned)phase < STATS_PHASE_COUNT ? names[phase] : "unknown";
+}
+
+static void writeCountersJSON(const char *name, const SearchCounters *c, FILE *out) {
+    fprintf(out, "  \"%s\": {\"searches\": %zu, \"pops\": %zu, \"stale_pops\": %zu, \"relaxations\": %zu, \"queue_peak\": %zu}",
+            name, c->searches, c->pops, c->stalePops, c->relaxations, c->queuePeak);
+}
+
+void writeSolverStatsJSON(const SolverStats *stats, FILE *out) {
+    fprintf(out, "{\n  \"phases\": {\n");
+    for (int p = 0; p < STATS_PHASE_COUNT; p++) {
+        fprintf(out, "    \"%s\": {\"ms\": %.3f, \"bytes\": %zu}%s\n", statsPhaseName((StatsPhase)p),
+                stats->seconds[p] * 1e3, stats->bytes[p], p + 1 < STATS_PHASE_COUNT ? "," : "");
+    }
+    fprintf(out, "  },\n");
+    writeCountersJSON("dijkstra", &stats->dijkstra, out);
+    fprintf(out, ",\n");
+    writeCountersJSON("exact", &stats->exact, out);
+    fprintf(out, "\n}\n");
+}
@@ -0,0 +1,43 @@
+#ifndef PATHFINDER_STATS_H
+#define PATHFINDER_STATS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef enum {
+    STATS_LOAD = 0,
+    STATS_ACCESSIBILITY,
+    STATS_HEURISTIC,        // exact: A* lower bound tables
+    STATS_EXACT_SEARCH,
+    STATS_POSE_TABLE,       // Held-Karp: pose to pose fuel costs
+    STATS_HELD_KARP_DP,
+    STATS_MATRIX,           // approx: target cost matrix
+    STATS_TOUR,             // approx: MST, matching and Euler tour
+    STATS_LOCAL_SEARCH,
+    STATS_STITCH,           // leg searches that build the physical path
+    STATS_REPLAN,           // tree repairs and regrown trees after maze edits
+    STATS_PHASE_COUNT
+} StatsPhase;
+
+typedef struct {
+    size_t searches;
+    size_t pops;
+    size_t stalePops;       // popped with a key above the known dist
+    size_t relaxations;     // dist improvements, one push each
+    size_t queuePeak;       // most nodes queued at once in one search
+} SearchCounters;
+
+// filled while ctx->stats points here, every field adds up over calls until reset
+typedef struct {
+    double seconds[STATS_PHASE_COUNT];
+    size_t bytes[STATS_PHASE_COUNT];    // working buffers the phase allocated
+    SearchCounters dijkstra;            // single-source searches: Dijkstra*, pose table, matrix rows
+    SearchCounters exact;               // SolveTSP_Exact state search
+} SolverStats;
+
+void resetSolverStats(SolverStats *stats);
+void addSearchCounters(SearchCounters *into, const SearchCounters *from);
+const char* statsPhaseName(StatsPhase phase);
+void writeSolverStatsJSON(const SolverStats *stats, FILE *out);
+
+#endif
@@ -0,0 +1,75 @@
+#include "systhread.h"
+
+#ifndef SOLVER_NO_THREADS
+#include <stdlib.h>
+
+typedef struct {
+    SysThreadFn fn;
+    void *arg;
+} ThreadStart;
+
+#ifdef _WIN32
+static DWORD WINAPI threadMain(LPVOID param) {
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.fn(start.arg);
+    return 0;
+}
+
+bool startThread(SysThread *thread, SysThreadFn fn, void *arg) {
+    ThreadStart *start = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!start) return false;
+    start->fn = fn;
+    start->arg = arg;
+    *thread = CreateThread(NULL, 0, threadMain, start, 0, NULL);
+    if (!*thread) { free(start); return false; }
+    return true;
+}
+
+void joinThread(SysThread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+// SRW locks and condition variables need no cleanup
+void initMutex(SysMutex *mutex) { InitializeSRWLock(mutex); }
+void destroyMutex(SysMutex *mutex) { (void)mutex; }
+void lockMutex(SysMutex *mutex) { AcquireSRWLockExclusive(mutex); }
+void unlockMutex(SysMutex *mutex) { ReleaseSRWLockExclusive(mutex); }
+
+void initCond(SysCond *cond) { InitializeConditionVariable(cond); }
+void destroyCond(SysCond *cond) { (void)cond; }
+void waitCond(SysCond *cond, SysMutex *mutex) { SleepConditionVariableSRW(cond, mutex, INFINITE, 0); }
+void signalCond(SysCond *cond) { WakeConditionVariable(cond); }
+void broadcastCond(SysCond *cond) { WakeAllConditionVariable(cond); }
+#else
+static void* threadMain(void *param) {
+    ThreadStart start = *(ThreadStart*)param;
+    free(param);
+    start.fn(start.arg);
+    return NULL;
+}
+
+bool startThread(SysThread *thread, SysThreadFn fn, void *arg) {
+    ThreadStart *start = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!start) return false;
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(thread, NULL, threadMain, start) != 0) { free(start); return false; }
+    return true;
+}
+
+void joinThread(SysThread thread) { pthread_join(thread, NULL); }
+
+void initMutex(SysMutex *mutex) { pthread_mutex_init(mutex, NULL); }
+void destroyMutex(SysMutex *mutex) { pthread_mutex_destroy(mutex); }
+void lockMutex(SysMutex *mutex) { pthread_mutex_lock(mutex); }
+void unlockMutex(SysMutex *mutex) { pthread_mutex_unlock(mutex); }
+
+void initCond(SysCond *cond) { pthread_cond_init(cond, NULL); }
+void destroyCond(SysCond *cond) { pthread_cond_destroy(cond); }
+void waitCond(SysCond *cond, SysMutex *mutex) { pthread_cond_wait(cond, mutex); }
+void signalCond(SysCond *cond) { pthread_cond_signal(cond); }
+void broadcastCond(SysCond *cond) { pthread_cond_broadcast(cond); }
+#endif
+#endif
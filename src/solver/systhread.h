@@ -0,0 +1,41 @@
+#ifndef PATHFINDER_SYSTHREAD_H
+#define PATHFINDER_SYSTHREAD_H
+
+// Threads, mutexes and condition variables for the pool and the solve tasks: Win32
+// primitives on Windows, pthreads elsewhere. Building with SOLVER_NO_THREADS leaves
+// this header empty and both run their work on the calling thread.
+#ifndef SOLVER_NO_THREADS
+
+#include <stdbool.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE SysThread;
+typedef SRWLOCK SysMutex;
+typedef CONDITION_VARIABLE SysCond;
+#else
+#include <pthread.h>
+typedef pthread_t SysThread;
+typedef pthread_mutex_t SysMutex;
+typedef pthread_cond_t SysCond;
+#endif
+
+typedef void (*SysThreadFn)(void *arg);
+
+// false when the system has no thread to spare
+bool startThread(SysThread *thread, SysThreadFn fn, void *arg);
+void joinThread(SysThread thread);
+
+void initMutex(SysMutex *mutex);
+void destroyMutex(SysMutex *mutex);
+void lockMutex(SysMutex *mutex);
+void unlockMutex(SysMutex *mutex);
+
+void initCond(SysCond *cond);
+void destroyCond(SysCond *cond);
+void waitCond(SysCond *cond, SysMutex *mutex);
+void signalCond(SysCond *cond);
+void broadcastCond(SysCond *cond);
+
+#endif
+#endif
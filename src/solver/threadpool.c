@@ -0,0 +1,147 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "threadpool.h"
+#include "systhread.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+int GetCpuCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+struct ThreadPool {
+    int workerCount;
+#ifndef SOLVER_NO_THREADS
+    SysThread *threads;
+    SysMutex lock;
+    SysCond wake;
+    SysCond done;
+
+    // current job, guarded by lock
+    ParallelFn fn;
+    void *arg;
+    int count;
+    int next;
+    int active;
+    unsigned generation;
+    bool stop;
+#endif
+};
+
+#ifndef SOLVER_NO_THREADS
+typedef struct {
+    ThreadPool *pool;
+    int worker;
+} WorkerStart;
+
+// claims indices until the job runs dry, called with the lock held
+static void runClaims(ThreadPool *pool, int worker) {
+    while (pool->next < pool->count) {
+        int index = pool->next++;
+        ParallelFn fn = pool->fn;
+        void *arg = pool->arg;
+        unlockMutex(&pool->lock);
+        fn(arg, index, worker);
+        lockMutex(&pool->lock);
+    }
+}
+
+static void workerMain(void *param) {
+    WorkerStart start = *(WorkerStart*)param;
+    free(param);
+    ThreadPool *pool = start.pool;
+    unsigned seen = 0;
+
+    lockMutex(&pool->lock);
+    while (1) {
+        while (!pool->stop && pool->generation == seen) waitCond(&pool->wake, &pool->lock);
+        if (pool->stop) break;
+        seen = pool->generation;
+        pool->active++;
+        runClaims(pool, start.worker);
+        if (--pool->active == 0) signalCond(&pool->done);
+    }
+    unlockMutex(&pool->lock);
+}
+#endif
+
+ThreadPool* createThreadPool(int workerCount) {
+    ThreadPool *pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (workerCount <= 0) workerCount = GetCpuCount();
+#ifdef SOLVER_NO_THREADS
+    pool->workerCount = 1;
+#else
+    initMutex(&pool->lock);
+    initCond(&pool->wake);
+    initCond(&pool->done);
+    pool->threads = (SysThread*)malloc(sizeof(SysThread) * workerCount);
+    pool->workerCount = 1;
+    for (int w = 1; w < workerCount; w++) {
+        WorkerStart *start = (WorkerStart*)malloc(sizeof(WorkerStart));
+        start->pool = pool;
+        start->worker = w;
+        if (!startThread(&pool->threads[w], workerMain, start)) { free(start); break; }
+        pool->workerCount++;
+    }
+#endif
+    return pool;
+}
+
+void freeThreadPool(ThreadPool *pool) {
+    if (!pool) return;
+#ifndef SOLVER_NO_THREADS
+    lockMutex(&pool->lock);
+    pool->stop = true;
+    broadcastCond(&pool->wake);
+    unlockMutex(&pool->lock);
+    for (int w = 1; w < pool->workerCount; w++) joinThread(pool->threads[w]);
+    free(pool->threads);
+    destroyMutex(&pool->lock);
+    destroyCond(&pool->wake);
+    destroyCond(&pool->done);
+#endif
+    free(pool);
+}
+
+int threadPoolSize(const ThreadPool *pool) { return pool->workerCount; }
+
+void parallelFor(ThreadPool *pool, int count, ParallelFn fn, void *arg) {
+#ifdef SOLVER_NO_THREADS
+    (void)pool;
+    for (int i = 0; i < count; i++) fn(arg, i, 0);
+#else
+    if (pool->workerCount == 1) {
+        for (int i = 0; i < count; i++) fn(arg, i, 0);
+        return;
+    }
+    lockMutex(&pool->lock);
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->count = count;
+    pool->next = 0;
+    pool->generation++;
+    broadcastCond(&pool->wake);
+
+    // the calling thread works as worker 0
+    pool->active++;
+    runClaims(pool, 0);
+    pool->active--;
+    while (pool->active > 0) waitCond(&pool->done, &pool->lock);
+    unlockMutex(&pool->lock);
+#endif
+}
@@ -0,0 +1,22 @@
+#ifndef PATHFINDER_THREADPOOL_H
+#define PATHFINDER_THREADPOOL_H
+
+// workers run on Win32 threads on Windows and pthreads elsewhere, see systhread.h.
+// Builds that define SOLVER_NO_THREADS run every job on the calling thread.
+
+// fn(arg, index, worker) is called once per index, worker is in [0, workerCount)
+typedef void (*ParallelFn)(void *arg, int index, int worker);
+
+typedef struct ThreadPool ThreadPool;
+
+// workerCount includes the calling thread, 0 uses one worker per CPU
+ThreadPool* createThreadPool(int workerCount);
+void freeThreadPool(ThreadPool *pool);
+int threadPoolSize(const ThreadPool *pool);
+
+// runs fn for every index in [0, count), indices are handed out one at a time
+void parallelFor(ThreadPool *pool, int count, ParallelFn fn, void *arg);
+
+int GetCpuCount(void);
+
+#endif
@@ -0,0 +1,139 @@
+#include "solver_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Tour local search
+//
+// Improves a visiting order against the cost matrix of the approximate solver. The
+// order is an open path: order[0] is the start and stays first, the last node is free.
+// 2-opt and Or-opt run to a local optimum, then double-bridge kicks restart them from
+// the best order until the deadline passes. The clock and the cancel flag are checked
+// after every move, the first descent included, and the best order so far is kept.
+
+#define TOUR_C(a, b) cost[(size_t)(a) * stride + (b)]
+
+static int PathCost(const int *cost, int stride, const int *order, int count) {
+    int total = 0;
+    for (int i = 1; i < count; i++) total += TOUR_C(order[i - 1], order[i]);
+    return total;
+}
+
+static void Reverse(int *order, int i, int j) {
+    for (; i < j; i++, j--) { int t = order[i]; order[i] = order[j]; order[j] = t; }
+}
+
+// first improving segment reversal order[i..j], returns its gain or 0
+static int TwoOptMove(const int *cost, int stride, int *order, int count) {
+    for (int i = 1; i < count - 1; i++) {
+        int a = order[i - 1], b = order[i];
+        for (int j = i + 1; j < count; j++) {
+            int c = order[j];
+            int delta = TOUR_C(a, c) - TOUR_C(a, b);
+            if (j + 1 < count) delta += TOUR_C(b, order[j + 1]) - TOUR_C(c, order[j + 1]);
+            if (delta < 0) {
+                Reverse(order, i, j);
+                return -delta;
+            }
+        }
+    }
+    return 0;
+}
+
+// first improving move of a run of 1 to 3 nodes to another gap, either way round
+static int OrOptMove(const int *cost, int stride, int *order, int count, int *buffer) {
+    for (int len = 1; len <= 3; len++) {
+        for (int i = 1; i + len <= count; i++) {
+            int first = order[i], last = order[i + len - 1];
+            int prev = order[i - 1];
+            int next = (i + len < count) ? order[i + len] : -1;
+            int removeGain = TOUR_C(prev, first) + (next >= 0 ? TOUR_C(last, next) - TOUR_C(prev, next) : 0);
+
+            // gap after position g in the order without the run
+            for (int g = 0; g < count; g++) {
+                if (g >= i - 1 && g < i + len) continue;
+                int x = order[g];
+                int y = (g + 1 < count) ? order[g + 1] : -1;
+                if (g + 1 == i) continue;
+                for (int flip = 0; flip < 2; flip++) {
+                    int head = flip ? last : first, tail = flip ? first : last;
+                    int addCost = TOUR_C(x, head) + (y >= 0 ? TOUR_C(tail, y) - TOUR_C(x, y) : 0);
+                    int delta = addCost - removeGain;
+                    if (delta >= 0) continue;
+
+                    // rebuild: everything but the run, with the run placed after order[g]
+                    int n = 0;
+                    for (int k = 0; k < count; k++) {
+                        if (k >= i && k < i + len) continue;
+                        buffer[n++] = order[k];
+                        if (k == g) {
+                            for (int r = 0; r < len; r++) buffer[n++] = order[flip ? i + len - 1 - r : i + r];
+                        }
+                    }
+                    memcpy(order, buffer, sizeof(int) * count);
+                    return -delta;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// splits order[1..) into A B C D and reconnects as A C B D
+static void DoubleBridge(int *order, int count, int *buffer, unsigned *seed) {
+    if (count < 5) return;
+    int cut[3];
+    for (int k = 0; k < 3; k++) {
+        *seed = *seed * 1103515245u + 12345u;
+        cut[k] = 1 + (int)((*seed >> 8) % (unsigned)(count - 1));
+    }
+    if (cut[0] > cut[1]) { int t = cut[0]; cut[0] = cut[1]; cut[1] = t; }
+    if (cut[1] > cut[2]) { int t = cut[1]; cut[1] = cut[2]; cut[2] = t; }
+    if (cut[0] > cut[1]) { int t = cut[0]; cut[0] = cut[1]; cut[1] = t; }
+    if (cut[0] == cut[1] || cut[1] == cut[2]) return;
+
+    int n = 0;
+    for (int k = 0; k < cut[0]; k++) buffer[n++] = order[k];
+    for (int k = cut[1]; k < cut[2]; k++) buffer[n++] = order[k];
+    for (int k = cut[0]; k < cut[1]; k++) buffer[n++] = order[k];
+    for (int k = cut[2]; k < count; k++) buffer[n++] = order[k];
+    memcpy(order, buffer, sizeof(int) * count);
+}
+
+int ImproveTour(const SolverContext *ctx, const int *cost, int stride, int *order, int count, double deadline, TourReport report, void *user) {
+    int bestCost = PathCost(cost, stride, order, count);
+    if (count < 3) return bestCost;
+
+    int *current = (int*)malloc(sizeof(int) * count);
+    int *buffer = (int*)malloc(sizeof(int) * count);
+    memcpy(current, order, sizeof(int) * count);
+    int currentCost = bestCost;
+    unsigned seed = 12345u;
+    bool running = true;
+
+    while (running) {
+        // descend to a local optimum, or until the deadline or a cancel stops the moves
+        int gain;
+        do {
+            gain = TwoOptMove(cost, stride, current, count);
+            if (gain == 0) gain = OrOptMove(cost, stride, current, count, buffer);
+            currentCost -= gain;
+            running = SolverGetTime() < deadline && ProgressTick(ctx, 0, bestCost);
+        } while (gain > 0 && running);
+
+        if (currentCost < bestCost) {
+            bestCost = currentCost;
+            memcpy(order, current, sizeof(int) * count);
+            if (report) report(user, order, count, bestCost);
+        }
+        if (!running) break;
+
+        // kick the best order and descend again
+        memcpy(current, order, sizeof(int) * count);
+        DoubleBridge(current, count, buffer, &seed);
+        currentCost = PathCost(cost, stride, current, count);
+    }
+
+    free(current);
+    free(buffer);
+    return bestCost;
+}
@@ -0,0 +1,32 @@
+#include <stdio.h>
+
+#include "test/test.h"
+
+// Held-Karp runs its DP over the poses covering a target and has to find the same
+// optimum as the bitmask search over every (pose, target mask) state
+int CheckHeldKarpMatchesExact(void) {
+    int mismatches = 0;
+    for (int seed = 1; seed <= 24; seed++) {
+        MazeGenParams params = {20 + seed % 5 * 4, 24 + seed % 7 * 3, 0.04 * (seed % 4), 2 + seed % 6, seed % 3 == 0 ? 3 : 0, (uint64_t)seed};
+        SolverContext ctx;
+        SolverInit(&ctx);
+        ctx.workerCount = 1;
+        if (!LoadGeneratedMaze(&ctx, &params)) {
+            TestFail("held-karp", &params, "maze not loaded");
+            mismatches++;
+            SolverFree(&ctx);
+            continue;
+        }
+        CheckAccessibility(&ctx);
+        if (ctx.reachableCount > 0) {
+            int exact = SolveTSP_Exact(&ctx) ? ctx.totalFuelCost : -1;
+            int heldKarp = SolveTSP_HeldKarp(&ctx) ? ctx.totalFuelCost : -1;
+            if (exact < 0 || exact != heldKarp) {
+                TestFail("held-karp", &params, "exact cost %d, Held-Karp cost %d", exact, heldKarp);
+                mismatches++;
+            }
+        }
+        SolverFree(&ctx);
+    }
+    return mismatches;
+}
@@ -0,0 +1,83 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test/test.h"
+
+// test runner: runs every check, or the ones named on the command line, and exits
+// with 1 when any of them found a mismatch
+typedef struct {
+    const char *name;
+    int (*run)(void);
+} TestCheck;
+
+static const TestCheck checks[] = {
+    {"held-karp", CheckHeldKarpMatchesExact},
+    {"reach", CheckBitsetReachability},
+    {"binary", CheckBinaryRoundTrip},
+    {"path", CheckPathTrace},
+    {"replan", CheckReplanMatchesCold},
+};
+
+bool LoadGeneratedMaze(SolverContext *ctx, const MazeGenParams *params) {
+    uint8_t *grid = GenerateMaze(params);
+    if (!grid) return false;
+    size_t size = (size_t)params->rows * (params->cols + 1), k = 0;
+    char *text = (char*)malloc(size);
+    if (!text) { free(grid); return false; }
+    for (int r = 0; r < params->rows; r++) {
+        for (int c = 0; c < params->cols; c++) text[k++] = (char)('0' + grid[(size_t)r * params->cols + c]);
+        text[k++] = '\n';
+    }
+    free(grid);
+    bool loaded = LoadMazeFromMemory(ctx, text, size);
+    free(text);
+    return loaded;
+}
+
+char* MazeToText(const SolverContext *ctx, size_t *size) {
+    *size = (size_t)ctx->rows * (ctx->cols + 1);
+    char *text = (char*)malloc(*size);
+    if (!text) return NULL;
+    size_t k = 0;
+    for (int r = 0; r < ctx->rows; r++) {
+        for (int c = 0; c < ctx->cols; c++) text[k++] = (char)('0' + MAZE_AT(ctx, r, c));
+        text[k++] = '\n';
+    }
+    return text;
+}
+
+void TestFail(const char *check, const MazeGenParams *params, const char *format, ...) {
+    fprintf(stderr, "%s: --rows %d --cols %d --density %g --targets %d --corridor %d --seed %llu: ", check, params->rows,
+            params->cols, params->density, params->targets, params->corridor, (unsigned long long)params->seed);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+    int count = (int)(sizeof(checks) / sizeof(checks[0]));
+    int failed = 0;
+    for (int i = 1; i < argc; i++) {
+        bool known = false;
+        for (int c = 0; c < count; c++) known = known || strcmp(argv[i], checks[c].name) == 0;
+        if (!known) {
+            fprintf(stderr, "usage: %s [check...], checks:", argv[0]);
+            for (int c = 0; c < count; c++) fprintf(stderr, " %s", checks[c].name);
+            fprintf(stderr, "\n");
+            return 2;
+        }
+    }
+    for (int c = 0; c < count; c++) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++) selected = selected || strcmp(argv[i], checks[c].name) == 0;
+        if (!selected) continue;
+        int mismatches = checks[c].run();
+        printf("%-12s %s\n", checks[c].name, mismatches ? "FAILED" : "ok");
+        if (mismatches) failed++;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test/test.h"
+
+#define ROUND_TRIP_FILE "pathfinder-test.maze"
+
+// a maze saved with SaveMazeBinary reads back through LoadMaze with the same cells,
+// start pose and reachable poses as the text it came from
+int CheckBinaryRoundTrip(void) {
+    int mismatches = 0;
+    for (int seed = 1; seed <= 16; seed++) {
+        MazeGenParams params = {16 + seed * 5 % 40, 16 + seed * 11 % 90, 0.02 * (seed % 4), seed % 9, seed % 3 == 2 ? 4 : 0, (uint64_t)seed};
+        SolverContext text, binary;
+        SolverInit(&text);
+        SolverInit(&binary);
+        const char *problem = NULL;
+        if (!LoadGeneratedMaze(&text, &params)) problem = "maze not loaded";
+        else if (!SaveMazeBinary(&text, ROUND_TRIP_FILE)) problem = "maze not saved";
+        else if (!LoadMaze(&binary, ROUND_TRIP_FILE)) problem = "binary maze not loaded";
+        else if (binary.rows != text.rows || binary.cols != text.cols) problem = "size differs";
+        else if (memcmp(binary.maze, text.maze, (size_t)text.rows * text.cols) != 0) problem = "cells differ";
+        else if (memcmp(&binary.start_state, &text.start_state, sizeof(State)) != 0) problem = "start pose differs";
+        if (!problem) {
+            CheckAccessibility(&text);
+            CheckAccessibility(&binary);
+            if (binary.reachableCount != text.reachableCount || binary.poseIndex.count != text.poseIndex.count) problem = "reachability differs";
+        }
+        if (problem) {
+            TestFail("binary", &params, "%s", problem);
+            mismatches++;
+        }
+        SolverFree(&text);
+        SolverFree(&binary);
+    }
+    remove(ROUND_TRIP_FILE);
+    return mismatches;
+}
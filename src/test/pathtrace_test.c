@@ -0,0 +1,125 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "test/test.h"
+
+#define WALK_STEPS (4 * PATH_MARK_STEPS + 7)
+
+// index of the move taking a to b, -1 when none does or b is blocked
+static int MoveBetween(const SolverContext *ctx, PathStep a, PathStep b) {
+    if (!IsPoseFree(ctx, b.x, b.y, b.m)) return -1;
+    for (int i = 0; i < 8; i++) {
+        const int *mv = ctx->moves[a.m][i];
+        if (mv[0] == b.m && a.x + mv[1] == b.x && a.y + mv[2] == b.y) return i;
+    }
+    return -1;
+}
+
+static bool SameStep(PathStep a, PathStep b) { return a.x == b.x && a.y == b.y && a.m == b.m; }
+
+// random walk from the start over free poses, several marks long
+static int RandomWalk(const SolverContext *ctx, uint64_t seed, PathStep *steps) {
+    uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    PathStep s = {ctx->start_state.x, ctx->start_state.y, ctx->start_state.mode};
+    steps[0] = s;
+    int count = 1;
+    while (count < WALK_STEPS) {
+        int open[8], openCount = 0;
+        for (int i = 0; i < 8; i++) {
+            const int *mv = ctx->moves[s.m][i];
+            if (IsPoseFree(ctx, s.x + mv[1], s.y + mv[2], mv[0])) open[openCount++] = i;
+        }
+        if (openCount == 0) break;
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        const int *mv = ctx->moves[s.m][open[state % (uint64_t)openCount]];
+        s = (PathStep){s.x + mv[1], s.y + mv[2], mv[0]};
+        steps[count++] = s;
+    }
+    return count;
+}
+
+// the packed trace of a walk decodes to the same steps, stepping from the start, seeking
+// around every mark and reading single steps
+static int CheckWalkTrace(const SolverContext *ctx, const MazeGenParams *params, const PathStep *steps, int count) {
+    PathTrace trace = {0};
+    if (!PathTraceStart(&trace, steps[0]) || !PathTraceAppend(ctx, &trace, steps + 1, count - 1)) {
+        TestFail("path", params, "walk of %d steps not stored", count);
+        PathTraceFree(&trace);
+        return 1;
+    }
+    int bad = 0;
+    PathCursor cursor;
+    int seen = 0;
+    for (bool more = PathCursorSeek(&cursor, ctx, &trace, 0); more; more = PathCursorNext(&cursor)) {
+        if (cursor.index != seen || !SameStep(cursor.step, steps[seen])) bad++;
+        seen++;
+    }
+    if (seen != count || trace.count != count || !SameStep(trace.last, steps[count - 1])) bad++;
+    for (int mark = 0; mark * PATH_MARK_STEPS < count + PATH_MARK_STEPS; mark++) {
+        for (int at = mark * PATH_MARK_STEPS - 2; at <= mark * PATH_MARK_STEPS + 2; at++) {
+            bool inside = at >= 0 && at < count;
+            if (PathCursorSeek(&cursor, ctx, &trace, at) != inside) { bad++; continue; }
+            if (inside && !SameStep(cursor.step, steps[at])) bad++;
+            if (inside && at + 1 < count && (!PathCursorNext(&cursor) || !SameStep(cursor.step, steps[at + 1]))) bad++;
+        }
+    }
+    for (int at = 0; at < count; at += 97) if (!SameStep(PathTraceAt(ctx, &trace, at), steps[at])) bad++;
+    PathTraceFree(&trace);
+    if (bad) TestFail("path", params, "%d decoded steps differ over a %d step walk", bad, count);
+    return bad ? 1 : 0;
+}
+
+// every step of a solved tour is one legal move on, the fuel adds up to the tour cost
+// and each reachable objective is covered on the way
+static int CheckSolvedTrace(SolverContext *ctx, const MazeGenParams *params) {
+    CheckAccessibility(ctx);
+    if (ctx->reachableCount == 0) return 0;
+    if (!SolveTSP_Approx(ctx)) {
+        TestFail("path", params, "approximate solve failed");
+        return 1;
+    }
+    bool *covered = (bool*)calloc(ctx->objCount, sizeof(bool));
+    int fuel = 0, illegal = 0;
+    PathCursor cursor;
+    PathStep prev = {0, 0, 0};
+    for (bool more = PathCursorSeek(&cursor, ctx, &ctx->tspPath, 0); more; more = PathCursorNext(&cursor)) {
+        PathStep s = cursor.step;
+        if (cursor.index > 0) {
+            int move = MoveBetween(ctx, prev, s);
+            if (move < 0) illegal++;
+            else fuel += ctx->moves[prev.m][move][3];
+        }
+        for (int i = 0; i < ctx->objCount; i++) covered[i] = covered[i] || PoseCoversCell(s.x, s.y, s.m, ctx->objectives[i].x, ctx->objectives[i].y);
+        prev = s;
+    }
+    int missed = 0;
+    for (int i = 0; i < ctx->objCount; i++) missed += ctx->objectives[i].reachable && !covered[i];
+    free(covered);
+    if (illegal || missed || fuel != ctx->totalFuelCost) {
+        TestFail("path", params, "%d illegal steps, %d objectives missed, fuel %d for cost %d", illegal, missed, fuel, ctx->totalFuelCost);
+        return 1;
+    }
+    return 0;
+}
+
+int CheckPathTrace(void) {
+    PathStep *steps = (PathStep*)malloc(WALK_STEPS * sizeof(PathStep));
+    if (!steps) return 1;
+    int mismatches = 0;
+    for (int seed = 1; seed <= 8; seed++) {
+        MazeGenParams params = {60 + seed * 13 % 70, 80 + seed * 29 % 90, 0.01 * (seed % 3), 6 + seed % 5, seed % 4 == 3 ? 5 : 0, (uint64_t)seed};
+        SolverContext ctx;
+        SolverInit(&ctx);
+        if (!LoadGeneratedMaze(&ctx, &params)) {
+            TestFail("path", &params, "maze not loaded");
+            mismatches++;
+        } else {
+            int count = RandomWalk(&ctx, params.seed, steps);
+            mismatches += CheckWalkTrace(&ctx, &params, steps, count);
+            mismatches += CheckSolvedTrace(&ctx, &params);
+        }
+        SolverFree(&ctx);
+    }
+    free(steps);
+    return mismatches;
+}
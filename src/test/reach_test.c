@@ -0,0 +1,60 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "test/test.h"
+
+// poses reachable from the start by a queue BFS over IsPoseFree and the move table,
+// one pose at a time, as the accessibility check worked before the bitset search
+bool* ScalarReachable(const SolverContext *ctx) {
+    size_t totalPoses = (size_t)ctx->rows * ctx->cols * 4;
+    bool *seen = (bool*)calloc(totalPoses, sizeof(bool));
+    State *queue = (State*)malloc(totalPoses * sizeof(State));
+    if (!seen || !queue) { free(seen); free(queue); return NULL; }
+    State s = ctx->start_state;
+    size_t head = 0, tail = 0;
+    if (IsPoseFree(ctx, s.x, s.y, s.mode)) {
+        seen[IDX_POS(s.y, s.x, s.mode, ctx->cols)] = true;
+        queue[tail++] = s;
+    }
+    while (head < tail) {
+        State u = queue[head++];
+        for (int i = 0; i < 8; i++) {
+            const int *mv = ctx->moves[u.mode][i];
+            State v = {u.x + mv[1], u.y + mv[2], mv[0]};
+            if (!IsPoseFree(ctx, v.x, v.y, v.mode) || seen[IDX_POS(v.y, v.x, v.mode, ctx->cols)]) continue;
+            seen[IDX_POS(v.y, v.x, v.mode, ctx->cols)] = true;
+            queue[tail++] = v;
+        }
+    }
+    free(queue);
+    return seen;
+}
+
+// column counts around the 64-pose words of the bitset rows, where shifts carry over
+int CheckBitsetReachability(void) {
+    static const int widths[] = {7, 63, 64, 65, 127, 128, 130, 191};
+    int mismatches = 0;
+    for (int seed = 1; seed <= 32; seed++) {
+        int cols = widths[seed % 8];
+        MazeGenParams params = {12 + seed * 3 % 50, cols, 0.02 * (seed % 5), 4, seed % 4 == 1 ? 4 : seed % 4 == 3 ? 6 : 0, (uint64_t)seed};
+        SolverContext ctx;
+        SolverInit(&ctx);
+        if (!LoadGeneratedMaze(&ctx, &params)) {
+            TestFail("reach", &params, "maze not loaded");
+            mismatches++;
+            SolverFree(&ctx);
+            continue;
+        }
+        CheckAccessibility(&ctx);
+        bool *seen = ScalarReachable(&ctx);
+        size_t totalPoses = (size_t)ctx.rows * ctx.cols * 4, differ = 0;
+        for (size_t i = 0; seen && ctx.visited && i < totalPoses; i++) differ += seen[i] != ctx.visited[i];
+        if (!seen || !ctx.visited || differ > 0) {
+            TestFail("reach", &params, "%zu poses differ from the scalar BFS", differ);
+            mismatches++;
+        }
+        free(seen);
+        SolverFree(&ctx);
+    }
+    return mismatches;
+}
@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test/test.h"
+
+static uint64_t NextEdit(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// one edit in three walls off a cell of the current path, the others flip a random
+// cell between wall and floor or place an objective
+static bool EditMaze(SolverContext *ctx, uint64_t *state) {
+    int x, y, value;
+    if (NextEdit(state) % 3 == 0 && ctx->tspPath.count > 1) {
+        PathStep s = PathTraceAt(ctx, &ctx->tspPath, 1 + (int)(NextEdit(state) % (uint64_t)(ctx->tspPath.count - 1)));
+        x = s.x;
+        y = s.y;
+        value = 0;
+    } else {
+        x = (int)(NextEdit(state) % (uint64_t)ctx->cols);
+        y = (int)(NextEdit(state) % (uint64_t)ctx->rows);
+        value = NextEdit(state) % 5 == 0 ? 3 : MAZE_AT(ctx, y, x) == 0 ? 1 : 0;
+    }
+    return MAZE_AT(ctx, y, x) != 2 && SetMazeCell(ctx, x, y, value);
+}
+
+// a re-plan after edits strikes the same objectives and pays the same fuel as a cold
+// approximate solve of the edited maze, and its patched reachable poses match a BFS
+int CheckReplanMatchesCold(void) {
+    int mismatches = 0;
+    for (int seed = 1; seed <= 12; seed++) {
+        MazeGenParams params = {24 + seed * 7 % 40, 24 + seed * 13 % 60, 0.03 * (seed % 4), 4 + seed % 6, seed % 3 == 1 ? 4 : 0, (uint64_t)seed};
+        SolverContext live;
+        SolverInit(&live);
+        if (!LoadGeneratedMaze(&live, &params)) {
+            TestFail("replan", &params, "maze not loaded");
+            mismatches++;
+            SolverFree(&live);
+            continue;
+        }
+        bool planned = StartReplanner(&live);
+        uint64_t state = params.seed * 0x9E3779B97F4A7C15ULL + 1;
+        for (int edit = 0; edit < 24 && live.replanner; edit++) {
+            if (!EditMaze(&live, &state)) continue;
+            planned = Replan(&live);
+
+            size_t totalPoses = (size_t)live.rows * live.cols * 4, differ = 0;
+            bool *seen = ScalarReachable(&live);
+            for (size_t i = 0; seen && i < totalPoses; i++) differ += seen[i] != live.visited[i];
+            free(seen);
+
+            size_t size;
+            char *text = MazeToText(&live, &size);
+            SolverContext cold;
+            SolverInit(&cold);
+            LoadMazeFromMemory(&cold, text, size);
+            cold.start_state = live.start_state;
+            CheckAccessibility(&cold);
+            bool coldPlanned = cold.reachableCount > 0 && SolveTSP_Approx(&cold);
+            size_t coldSize;
+            char *coldText = MazeToText(&cold, &coldSize);
+            bool sameMaze = coldSize == size && memcmp(coldText, text, size) == 0;
+            int liveCost = planned ? live.totalFuelCost : -1, coldCost = coldPlanned ? cold.totalFuelCost : -1;
+            if (differ > 0 || !sameMaze || live.reachableCount != cold.reachableCount || liveCost != coldCost) {
+                TestFail("replan", &params, "edit %d: %zu poses differ from a BFS, %s maze, %d objectives cost %d, cold %d cost %d", edit,
+                         differ, sameMaze ? "same" : "different", live.reachableCount, liveCost, cold.reachableCount, coldCost);
+                mismatches++;
+                edit = 24;
+            }
+            free(text);
+            free(coldText);
+            SolverFree(&cold);
+        }
+        SolverFree(&live);
+    }
+    return mismatches;
+}
@@ -0,0 +1,29 @@
+#ifndef PATHFINDER_TEST_H
+#define PATHFINDER_TEST_H
+
+#include <stdbool.h>
+
+#include "bench/mazegen.h"
+#include "solver/solver.h"
+
+// Seeded checks of the solver's fast paths against plain counterparts on generated
+// mazes. Each check returns the number of mismatches it found and reports them
+// through TestFail with the generator parameters, so the maze can be rebuilt with
+// the bench's --keep.
+
+// ctx holds the generated maze, read through LoadMazeFromMemory like a text file
+bool LoadGeneratedMaze(SolverContext *ctx, const MazeGenParams *params);
+// the maze text LoadMaze reads back into the same maze, free it after use
+char* MazeToText(const SolverContext *ctx, size_t *size);
+void TestFail(const char *check, const MazeGenParams *params, const char *format, ...);
+
+// the poses a queue BFS reaches from the start, rows*cols*4 flags to free
+bool* ScalarReachable(const SolverContext *ctx);
+
+int CheckHeldKarpMatchesExact(void);
+int CheckBitsetReachability(void);
+int CheckBinaryRoundTrip(void);
+int CheckPathTrace(void);
+int CheckReplanMatchesCold(void);
+
+#endif